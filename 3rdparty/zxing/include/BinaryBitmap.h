@@ -7,16 +7,15 @@
 
 #pragma once
 
+#include "BitMatrix.h"
 #include "ImageView.h"
 
 #include <cstdint>
-#include <memory>
+#include <mutex>
 #include <vector>
 
 namespace ZXing {
 
-class BitMatrix;
-
 using PatternRow = std::vector<uint16_t>;
 
 /**
@@ -25,8 +24,8 @@ using PatternRow = std::vector<uint16_t>;
 */
 class BinaryBitmap
 {
-	struct Cache;
-	std::unique_ptr<Cache> _cache;
+	mutable std::once_flag _once;
+	mutable BitMatrix _matrix; // storage is handed on to the next bitmap on this thread when this one is destroyed
 	bool _inverted = false;
 	bool _closed = false;
 
@@ -36,11 +35,12 @@ protected:
 	/**
 	* Converts a 2D array of luminance data to 1 bit (true means black).
 	*
-	* @return The 2D array of bits for the image, nullptr on error.
+	* @param res receives the 2D array of bits for the image, its storage is reused
+	* @return false on error.
 	*/
-	virtual std::shared_ptr<const BitMatrix> getBlackMatrix() const = 0;
+	virtual bool getBlackMatrix(BitMatrix& res) const = 0;
 
-	BitMatrix binarize(const uint8_t threshold) const;
+	void binarize(const uint8_t threshold, BitMatrix& res) const;
 
 public:
 	BinaryBitmap(const ImageView& buffer);
@@ -12,6 +12,7 @@
 #include "Range.h"
 
 #include <cstdint>
+#include <limits>
 #include <stdexcept>
 #include <vector>
 
@@ -72,6 +73,19 @@ public:
 
 	BitMatrix copy() const { return *this; }
 
+	/**
+	* Resize to width x height with all bits unset. The existing storage is kept when it is large enough,
+	* so a matrix that is refilled for every decode attempt does not touch the heap after the first one.
+	*/
+	void reset(int width, int height)
+	{
+		if (width < 0 || height < 0 || (width != 0 && height > std::numeric_limits<int>::max() / width))
+			throw std::invalid_argument("Invalid size: width * height is too big");
+		_bits.assign(width * height, UNSET_V);
+		_width = width;
+		_height = height;
+	}
+
 	Range<data_t*> row(int y) { return {_bits.data() + y * _width, _bits.data() + (y + 1) * _width}; }
 	Range<const data_t*> row(int y) const { return {_bits.data() + y * _width, _bits.data() + (y + 1) * _width}; }
 
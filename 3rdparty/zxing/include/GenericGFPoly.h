@@ -88,6 +88,18 @@ public:
 		_field = &field;
 		return *this;
 	}
+	/**
+	* @brief replace the coefficients, reusing the existing storage (see the constructor for the layout)
+	*/
+	GenericGFPoly& setCoefficients(const std::vector<int>& coefficients)
+	{
+		assert(!coefficients.empty());
+		_coefficients.resize(coefficients.size());
+		std::copy(coefficients.begin(), coefficients.end(), _coefficients.begin());
+		normalize();
+		return *this;
+	}
+
 	const GenericGF& field() const noexcept { return *_field; }
 	const auto& coefficients() const noexcept { return _coefficients; }
 
@@ -28,7 +28,7 @@ public:
 	~GlobalHistogramBinarizer() override;
 
 	bool getPatternRow(int row, int rotation, PatternRow &res) const override;
-	std::shared_ptr<const BitMatrix> getBlackMatrix() const override;
+	bool getBlackMatrix(BitMatrix& res) const override;
 };
 
 } // ZXing
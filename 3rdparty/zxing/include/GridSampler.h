@@ -33,10 +33,11 @@ namespace ZXing {
 * @param width width of {@link BitMatrix} to sample from image
 * @param height height of {@link BitMatrix} to sample from image
 * @param mod2Pix transforming a module (grid) coordinate into an image (pixel) coordinate
+* @param reuse matrix whose storage is taken over by the result, e.g. the grid of a previous attempt
 * @return {@link DetectorResult} representing a grid of points sampled from the image within a region
 *   defined by the "src" parameters. Result is empty if transformation is invalid (out of bound access).
 */
-DetectorResult SampleGrid(const BitMatrix& image, int width, int height, const PerspectiveTransform& mod2Pix);
+DetectorResult SampleGrid(const BitMatrix& image, int width, int height, const PerspectiveTransform& mod2Pix, BitMatrix&& reuse = {});
 
 template <typename PointT = PointF>
 Quadrilateral<PointT> Rectangle(int x0, int x1, int y0, int y1, typename PointT::value_t o = 0.5)
@@ -53,6 +54,6 @@ public:
 
 using ROIs = std::vector<ROI>;
 
-DetectorResult SampleGrid(const BitMatrix& image, int width, int height, const ROIs& rois);
+DetectorResult SampleGrid(const BitMatrix& image, int width, int height, const ROIs& rois, BitMatrix&& reuse = {});
 
 } // ZXing
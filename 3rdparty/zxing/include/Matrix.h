@@ -12,6 +12,7 @@
 #include <stdexcept>
 #include <algorithm>
 #include <cassert>
+#include <limits>
 #include <vector>
 
 namespace ZXing {
@@ -50,6 +51,16 @@ public:
 		return *this;
 	}
 
+	// Resize to width x height filled with val, keeping the existing storage when it is large enough.
+	void reset(int width, int height, value_t val = {})
+	{
+		if (width < 0 || height < 0 || (width != 0 && height > std::numeric_limits<int>::max() / width))
+			throw std::invalid_argument("Invalid size: width * height is too big");
+		_data.assign(width * height, val);
+		_width = width;
+		_height = height;
+	}
+
 	int height() const {
 		return _height;
 	}
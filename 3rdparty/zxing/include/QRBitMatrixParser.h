@@ -8,10 +8,13 @@
 
 #include "QRErrorCorrectionLevel.h"
 
+#include <array>
+#include <cstdint>
+#include <vector>
+
 namespace ZXing {
 
 class BitMatrix;
-class ByteArray;
 
 namespace QRCode {
 
@@ -32,10 +35,32 @@ const Version* ReadVersion(const BitMatrix& bitMatrix, Type type);
 FormatInformation ReadFormatInformation(const BitMatrix& bitMatrix);
 
 /**
- * @brief Reads the codewords from the BitMatrix.
- * @return bytes encoded within the QR Code or empty array if the exact number of bytes expected is not read
+ * @brief Placement of the codewords of one version and error correction level. The module offsets of every
+ * codeword are grouped by RS block, so a sampled symbol can be read de-interleaved in a single pass.
+ */
+struct CodewordLayout
+{
+	int dimension = 0;
+	int numBlocks = 0;
+	int totalDataCodewords = 0;
+	std::vector<int> blockOffsets;             // first codeword of each RS block, plus the total count
+	std::vector<int> numDataCodewords;         // data codewords of each RS block
+	std::vector<int> modules;                  // 8 module offsets per codeword, most significant bit first
+	std::vector<int> mirroredModules;          // module offsets in a mirrored (transposed) symbol
+	std::array<std::vector<uint8_t>, 8> masks; // data mask byte of every codeword, per mask pattern
+};
+
+/**
+ * @brief Returns the cached {@link CodewordLayout} for the version and error correction level.
+ */
+const CodewordLayout& GetCodewordLayout(const Version& version, ErrorCorrectionLevel ecLevel);
+
+/**
+ * @brief Reads the unmasked codewords of one RS block from the BitMatrix, data codewords first.
+ * The BitMatrix has to be of the layout's dimension.
  */
-ByteArray ReadCodewords(const BitMatrix& bitMatrix, const Version& version, const FormatInformation& formatInfo);
+void ReadBlockCodewords(const BitMatrix& bitMatrix, const CodewordLayout& layout, int block, const FormatInformation& formatInfo,
+						std::vector<int>& codewords);
 
 } // QRCode
 } // ZXing
@@ -27,10 +27,13 @@ struct FinderPatternSet
 using FinderPatterns = std::vector<ConcentricPattern>;
 using FinderPatternSets = std::vector<FinderPatternSet>;
 
-FinderPatterns FindFinderPatterns(const BitMatrix& image, bool tryHarder);
-FinderPatternSets GenerateFinderPatternSets(FinderPatterns& patterns);
+// The results are written to res, whose storage is reused when the same vector is passed on every call
+// moduleSize: expected module size in pixels, 0 if unknown; when given it sets the row step instead of tryHarder
+void FindFinderPatterns(const BitMatrix& image, bool tryHarder, FinderPatterns& res, int moduleSize = 0);
+void GenerateFinderPatternSets(FinderPatterns& patterns, FinderPatternSets& res);
 
-DetectorResult SampleQR(const BitMatrix& image, const FinderPatternSet& fp);
+// reuse: storage for the sampled grid, only moved from when a grid is actually returned
+DetectorResult SampleQR(const BitMatrix& image, const FinderPatternSet& fp, BitMatrix&& reuse = {});
 
 } // QRCode
 } // ZXing
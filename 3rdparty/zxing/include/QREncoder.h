@@ -6,13 +6,14 @@
 
 #pragma once
 
-#include "BitArray.h"
+#include <cstdint>
+#include <span>
 
 namespace ZXing::QRCode {
 
 enum class ErrorCorrectionLevel;
 class EncodeResult;
 
-EncodeResult Encode(const BitArray& dataBits, ErrorCorrectionLevel ecLevel, int versionNumber, int maskPattern = -1);
+EncodeResult Encode(std::span<const uint8_t> data, ErrorCorrectionLevel ecLevel, int versionNumber, int maskPattern = -1);
 
 } // namespace ZXing::QRCode
@@ -10,7 +10,7 @@
 
 namespace ZXing {
 
-class BitArray;
+class ByteArray;
 
 namespace QRCode {
 
@@ -19,7 +19,7 @@ class Version;
 
 constexpr int NUM_MASK_PATTERNS = 8;
 
-void BuildMatrix(const BitArray& dataBits, ErrorCorrectionLevel ecLevel, const Version& version, int maskPattern, TritMatrix& matrix);
+void BuildMatrix(const ByteArray& codewords, ErrorCorrectionLevel ecLevel, const Version& version, int maskPattern, TritMatrix& matrix);
 
 } // QRCode
 } // ZXing
@@ -17,6 +17,21 @@ namespace ZXing::QRCode {
 inline std::optional<int> qr_ecc;
 inline std::optional<int> qr_version;
 
+// Profiling hooks set by the caller, nothing is recorded while they are null
+inline void (*qr_zone)(const char* name, bool begin) = nullptr;
+inline void (*qr_count)(const char* name, long long value) = nullptr;
+
+struct TraceZone
+{
+	const char* name;
+
+	explicit TraceZone(const char* name) : name(name) { if (qr_zone) qr_zone(name, true); }
+	~TraceZone() { if (qr_zone) qr_zone(name, false); }
+
+	TraceZone(const TraceZone&) = delete;
+	TraceZone& operator=(const TraceZone&) = delete;
+};
+
 class Reader : public ZXing::Reader
 {
 public:
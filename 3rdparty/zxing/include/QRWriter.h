@@ -6,7 +6,8 @@
 
 #pragma once
 
-#include "BitArray.h"
+#include <cstdint>
+#include <span>
 
 namespace ZXing {
 
@@ -46,7 +47,13 @@ public:
 		return *this;
 	}
 
-	BitMatrix encode(const BitArray& contents, int width, int height) const;
+	BitMatrix encode(std::span<const uint8_t> contents, int width, int height) const;
+
+	/**
+	* Encodes "contents" into the bare module matrix, one entry per module and without quiet zone, so the caller
+	* can render it at any scale without an intermediate full-resolution BitMatrix.
+	*/
+	BitMatrix encode(std::span<const uint8_t> contents) const;
 
 private:
 	int _margin;
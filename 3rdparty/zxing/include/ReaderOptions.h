@@ -67,6 +67,7 @@ class ReaderOptions
 
 	uint8_t _minLineCount        = 2;
 	uint8_t _maxNumberOfSymbols  = 0xff;
+	uint8_t _moduleSize          = 0;
 	uint16_t _downscaleThreshold = 500;
 	BarcodeFormats _formats      = BarcodeFormat::None;
 
@@ -138,6 +139,11 @@ public:
 	/// The maximum number of symbols (barcodes) to detect / look for in the image with ReadBarcodes
 	ZX_PROPERTY(uint8_t, maxNumberOfSymbols, setMaxNumberOfSymbols)
 
+	/// Expected module size in pixels of the image passed to the reader, 0 if unknown (default). If set, the QR Code finder
+	/// pattern search visits one row per module instead of a step derived from the image height or tryHarder
+	// WARNING: this API is experimental and may change/disappear
+	ZX_PROPERTY(uint8_t, moduleSize, setModuleSize)
+
 	/// Enable the heuristic to detect and decode "full ASCII"/extended Code39 symbols
 	ZX_PROPERTY(bool, tryCode39ExtendedMode, setTryCode39ExtendedMode)
 
@@ -7,6 +7,7 @@
 
 #include "Point.h"
 #include "ZXAlgorithms.h"
+#include "ZXConfig.h"
 
 #include <algorithm>
 #include <cmath>
@@ -63,7 +64,8 @@ public:
 
 	template<typename T> RegressionLine(PointT<T> a, PointT<T> b)
 	{
-		evaluate(std::vector{a, b});
+		const PointT<T> points[] = {a, b};
+		evaluate(points, points + 2);
 	}
 
 	template<typename T> RegressionLine(const PointT<T>* b, const PointT<T>* e)
@@ -107,7 +109,8 @@ public:
 	{
 		bool ret = evaluate(_points);
 		if (maxSignedDist > 0) {
-			auto points = _points;
+			ZX_THREAD_LOCAL std::vector<PointF> points;
+			points.assign(_points.begin(), _points.end());
 			while (true) {
 				auto old_points_size = points.size();
 				// remove points that are further 'inside' than maxSignedDist or further 'outside' than 2 x maxSignedDist
@@ -136,7 +139,7 @@ public:
 			}
 
 			if (updatePoints)
-				_points = std::move(points);
+				_points.assign(points.begin(), points.end());
 		}
 		return ret;
 	}
@@ -6,20 +6,24 @@
 #include "BinaryBitmap.h"
 
 #include "BitMatrix.h"
+#include "ZXConfig.h"
 
 #include <mutex>
+#include <utility>
 
 namespace ZXing {
 
-struct BinaryBitmap::Cache
+// Swaps m with the matrix of the last bitmap destroyed on this thread. Decoding one image after another thus binarizes
+// into the same buffer instead of allocating a new one per image. Without ZX_THREAD_LOCAL there is nothing to reuse.
+static void SwapSpare(BitMatrix& m)
 {
-	std::once_flag once;
-	std::shared_ptr<const BitMatrix> matrix;
-};
+	ZX_THREAD_LOCAL BitMatrix spare;
+	std::swap(m, spare);
+}
 
-BitMatrix BinaryBitmap::binarize(const uint8_t threshold) const
+void BinaryBitmap::binarize(const uint8_t threshold, BitMatrix& res) const
 {
-	BitMatrix res(width(), height());
+	res.reset(width(), height());
 
 	if (_buffer.pixStride() == 1 && _buffer.rowStride() == _buffer.width()) {
 		// Specialize for a packed buffer with pixStride 1 to support auto vectorization (16x speedup on AVX2)
@@ -43,26 +47,30 @@ BitMatrix BinaryBitmap::binarize(const uint8_t threshold) const
 			}
 		}
 	}
-
-	return res;
 }
 
-BinaryBitmap::BinaryBitmap(const ImageView& buffer) : _cache(new Cache), _buffer(buffer) {}
+BinaryBitmap::BinaryBitmap(const ImageView& buffer) : _buffer(buffer) {}
 
-BinaryBitmap::~BinaryBitmap() = default;
+BinaryBitmap::~BinaryBitmap()
+{
+	if (!_matrix.empty())
+		SwapSpare(_matrix);
+}
 
 const BitMatrix* BinaryBitmap::getBitMatrix() const
 {
-	std::call_once(_cache->once, [&](){_cache->matrix = getBlackMatrix();});
-	return _cache->matrix.get();
+	std::call_once(_once, [&]() {
+		SwapSpare(_matrix);
+		if (!getBlackMatrix(_matrix))
+			SwapSpare(_matrix);
+	});
+	return _matrix.empty() ? nullptr : &_matrix;
 }
 
 void BinaryBitmap::invert()
 {
-	if (_cache->matrix) {
-		auto matrix = const_cast<BitMatrix*>(_cache->matrix.get());
-		matrix->flipAll();
-	}
+	if (!_matrix.empty())
+		_matrix.flipAll();
 	_inverted = true;
 }
 
@@ -86,8 +94,8 @@ void SumFilter(const BitMatrix& in, BitMatrix& out, F func)
 
 void BinaryBitmap::close()
 {
-	if (_cache->matrix) {
-		auto& matrix = *const_cast<BitMatrix*>(_cache->matrix.get());
+	if (!_matrix.empty()) {
+		auto& matrix = _matrix;
 		BitMatrix tmp(matrix.width(), matrix.height());
 
 		// dilate
@@ -6,12 +6,21 @@
 
 #include "BitMatrix.h"
 
+#include "BitHacks.h"
 #include "Pattern.h"
 
 #include <algorithm>
 #include <stdexcept>
 #include <utility>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define ZX_ROW_RUNS_SSE2
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ZX_ROW_RUNS_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
 namespace ZXing {
 
 void
@@ -121,12 +130,102 @@ BitMatrix::getBottomRightOnBit(int& right, int& bottom) const
 	return true;
 }
 
+#ifdef ZX_ROW_RUNS_SSE2
+namespace {
+
+// Appends the length of every run that ends in the block of 64 pixels starting at x. Bit i of edges is set if pixel
+// x + i differs from its right neighbour.
+inline uint16_t* EmitRuns(uint64_t edges, int x, int& start, uint16_t* out)
+{
+	while (edges) {
+		int end = x + BitHacks::NumberOfTrailingZeros(edges) + 1;
+		*out++ = static_cast<uint16_t>(end - start);
+		start = end;
+		edges &= edges - 1;
+	}
+	return out;
+}
+
+// Both variants compare 64 pixels with their right neighbours per step, so they stop 65 pixels before the end of the row
+// and leave the remainder to the scalar loop in GetRowPattern().
+uint16_t* RowRunsSSE2(const uint8_t* row, int n, int& x, int& start, uint16_t* out)
+{
+	for (; x + 65 <= n; x += 64) {
+		uint64_t same = 0;
+		for (int i = 0; i < 64; i += 16) {
+			auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x + i));
+			auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x + i + 1));
+			same |= uint64_t(uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)))) << i;
+		}
+		out = EmitRuns(~same, x, start, out);
+	}
+	return out;
+}
+
+#ifdef ZX_ROW_RUNS_AVX2
+ZX_ROW_RUNS_AVX2 uint16_t* RowRunsAVX2(const uint8_t* row, int n, int& x, int& start, uint16_t* out)
+{
+	for (; x + 65 <= n; x += 64) {
+		auto a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x));
+		auto b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x + 1));
+		auto a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x + 32));
+		auto b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x + 33));
+		uint64_t same = uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a0, b0))))
+						| uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a1, b1)))) << 32;
+		out = EmitRuns(~same, x, start, out);
+	}
+	return out;
+}
+
+const bool HasAVX2 = __builtin_cpu_supports("avx2");
+#endif
+
+// Same output as GetPatternRow(Range, PatternRow&) for a row of pixels. Long runs cost a single mask test per 64 pixels
+// instead of a byte-wise (or 8 byte-wise) walk and the result buffer is not cleared beforehand.
+void GetRowPattern(const uint8_t* row, int n, PatternRow& res)
+{
+	if (n < 1) {
+		res.clear();
+		return;
+	}
+	res.resize(n + 2);
+	auto out = res.data();
+	if (row[0])
+		*out++ = 0; // first value is number of white pixels, here 0
+
+	int x = 0, start = 0;
+#ifdef ZX_ROW_RUNS_AVX2
+	if (HasAVX2)
+		out = RowRunsAVX2(row, n, x, start, out);
+#endif
+	out = RowRunsSSE2(row, n, x, start, out);
+	for (; x < n - 1; ++x) {
+		if (row[x] != row[x + 1]) {
+			*out++ = static_cast<uint16_t>(x + 1 - start);
+			start = x + 1;
+		}
+	}
+	*out++ = static_cast<uint16_t>(n - start);
+
+	if (row[n - 1])
+		*out++ = 0; // last value is number of white pixels, here 0
+
+	res.resize(out - res.data());
+}
+
+} // namespace
+#endif
+
 void GetPatternRow(const BitMatrix& matrix, int r, std::vector<uint16_t>& pr, bool transpose)
 {
 	if (transpose)
 		GetPatternRow(matrix.col(r), pr);
 	else
+#ifdef ZX_ROW_RUNS_SSE2
+		GetRowPattern(matrix.row(r).begin(), matrix.width(), pr);
+#else
 		GetPatternRow(matrix.row(r), pr);
+#endif
 }
 
 BitMatrix Inflate(BitMatrix&& input, int width, int height, int quietZone)
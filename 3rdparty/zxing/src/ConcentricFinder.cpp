@@ -7,6 +7,7 @@
 
 #include "RegressionLine.h"
 #include "ZXAlgorithms.h"
+#include "ZXConfig.h"
 
 namespace ZXing {
 
@@ -40,8 +41,8 @@ std::optional<PointF> CenterOfRing(const BitMatrix& image, PointI center, int ra
 #if 0
 	if (requireCircle) {
 		// alternative implementation with the aim of discarding closed loops that are not all circle like (M > 5*m)
-		auto points = CollectRingPoints(image, center, range, std::abs(nth), nth < 0);
-		if (points.empty())
+		ZX_THREAD_LOCAL std::vector<PointF> points;
+		if (!CollectRingPoints(image, center, range, std::abs(nth), nth < 0, points))
 			return {};
 		auto res = Reduce(points, PointF{}, std::plus{}) / Size(points);
 
@@ -112,19 +113,19 @@ std::optional<PointF> CenterOfRings(const BitMatrix& image, PointF center, int r
 	return sum / n;
 }
 
-static std::vector<PointF> CollectRingPoints(const BitMatrix& image, PointF center, int range, int edgeIndex, bool backup)
+static bool CollectRingPoints(const BitMatrix& image, PointF center, int range, int edgeIndex, bool backup, std::vector<PointF>& points)
 {
 	PointI centerI(center);
 	int radius = range;
 	BitMatrixCursorI cur(image, centerI, {0, 1});
 	if (!cur.stepToEdge(edgeIndex, radius, backup))
-		return {};
+		return false;
 	cur.turnRight(); // move clock wise and keep edge on the right/left depending on backup
 	const auto edgeDir = backup ? Direction::LEFT : Direction::RIGHT;
 
 	uint32_t neighbourMask = 0;
 	auto start = cur.p;
-	std::vector<PointF> points;
+	points.clear();
 	points.reserve(4 * range);
 
 	do {
@@ -134,18 +135,15 @@ static std::vector<PointF> CollectRingPoints(const BitMatrix& image, PointF cent
 		neighbourMask |= (1 << (4 + dot(bresenhamDirection(cur.p - centerI), PointI(1, 3))));
 
 		if (!cur.stepAlongEdge(edgeDir))
-			return {};
+			return false;
 
 		// use L-inf norm, simply because it is a lot faster than L2-norm and sufficiently accurate
 		if (maxAbsComponent(cur.p - centerI) > radius || centerI == cur.p || Size(points) > 4 * 2 * range)
-			return {};
+			return false;
 
 	} while (cur.p != start);
 
-	if (neighbourMask != 0b111101111)
-		return {};
-
-	return points;
+	return neighbourMask == 0b111101111;
 }
 
 static std::optional<QuadrilateralF> FitQadrilateralToPoints(PointF center, std::vector<PointF>& points)
@@ -204,8 +202,8 @@ static bool QuadrilateralIsPlausibleSquare(const QuadrilateralF q, int lineIndex
 
 static std::optional<QuadrilateralF> FitSquareToPoints(const BitMatrix& image, PointF center, int range, int lineIndex, bool backup)
 {
-	auto points = CollectRingPoints(image, center, range, lineIndex, backup);
-	if (points.empty())
+	ZX_THREAD_LOCAL std::vector<PointF> points;
+	if (!CollectRingPoints(image, center, range, lineIndex, backup, points))
 		return {};
 
 	auto res = FitQadrilateralToPoints(center, points);
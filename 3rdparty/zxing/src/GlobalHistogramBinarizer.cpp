@@ -139,8 +139,7 @@ bool GlobalHistogramBinarizer::getPatternRow(int row, int rotation, PatternRow&
 }
 
 // Does not sharpen the data, as this call is intended to only be used by 2D Readers.
-std::shared_ptr<const BitMatrix>
-GlobalHistogramBinarizer::getBlackMatrix() const
+bool GlobalHistogramBinarizer::getBlackMatrix(BitMatrix& res) const
 {
 	// Quickly calculates the histogram by sampling four rows from the image. This proved to be
 	// more robust on the blackbox tests than sampling a diagonal as we used to do.
@@ -157,11 +156,10 @@ GlobalHistogramBinarizer::getBlackMatrix() const
 
 	int blackPoint = EstimateBlackPoint(localBuckets);
 	if (blackPoint <= 0)
-		return {};
-
-
+		return false;
 
-	return std::make_shared<const BitMatrix>(binarize(blackPoint));
+	binarize(blackPoint, res);
+	return true;
 }
 
 } // ZXing
@@ -7,14 +7,20 @@
 
 #include "GridSampler.h"
 
+#include "ZXConfig.h"
+
+#include <utility>
+
 namespace ZXing {
 
-DetectorResult SampleGrid(const BitMatrix& image, int width, int height, const PerspectiveTransform& mod2Pix)
+DetectorResult SampleGrid(const BitMatrix& image, int width, int height, const PerspectiveTransform& mod2Pix, BitMatrix&& reuse)
 {
-	return SampleGrid(image, width, height, {ROI{0, width, 0, height, mod2Pix}});
+	ZX_THREAD_LOCAL ROIs rois;
+	rois.assign(1, ROI{0, width, 0, height, mod2Pix});
+	return SampleGrid(image, width, height, rois, std::move(reuse));
 }
 
-DetectorResult SampleGrid(const BitMatrix& image, int width, int height, const ROIs& rois)
+DetectorResult SampleGrid(const BitMatrix& image, int width, int height, const ROIs& rois, BitMatrix&& reuse)
 {
 	if (width <= 0 || height <= 0)
 		return {};
@@ -26,7 +32,8 @@ DetectorResult SampleGrid(const BitMatrix& image, int width, int height, const R
 			return {};
 	}
 
-	BitMatrix res(width, height);
+	BitMatrix res = std::move(reuse);
+	res.reset(width, height);
 	for (auto&& [x0, x1, y0, y1, mod2Pix] : rois) {
 		for (int y = y0; y < y1; ++y)
 			for (int x = x0; x < x1; ++x) {
@@ -36,8 +43,10 @@ DetectorResult SampleGrid(const BitMatrix& image, int width, int height, const R
 				// inner grid points is not. See #563. A true perspective transformation cannot have this property.
 				// The following check takes 100% care of the issue and turned out to be less of a performance impact than feared.
 				// TODO: Check some mathematical/numercial property of mod2Pix to determine if it is a perspective transforation.
-				if (!image.isIn(p))
+				if (!image.isIn(p)) {
+					reuse = std::move(res);
 					return {};
+				}
 
 #if 0
 				int sum = 0;
@@ -9,11 +9,12 @@
 
 #include "BitArray.h"
 #include "BitMatrix.h"
-#include "ByteArray.h"
 #include "QRDataMask.h"
 #include "QRFormatInformation.h"
 #include "QRVersion.h"
+#include "ZXConfig.h"
 
+#include <memory>
 #include <utility>
 
 namespace ZXing::QRCode {
@@ -57,16 +58,17 @@ FormatInformation ReadFormatInformation(const BitMatrix& bitMatrix)
 	return FormatInformation::DecodeQR(formatInfoBits1, formatInfoBits2);
 }
 
-static ByteArray ReadQRCodewords(const BitMatrix& bitMatrix, const Version& version, const FormatInformation& formatInfo)
+static CodewordLayout BuildCodewordLayout(const Version& version, ErrorCorrectionLevel ecLevel)
 {
-	BitMatrix functionPattern = version.buildFunctionPattern();
+	CodewordLayout layout;
+	layout.dimension = version.dimension();
 
-	ByteArray result;
-	result.reserve(version.totalCodewords());
-	uint8_t currentByte = 0;
+	// Collect the data modules in reading order
+	BitMatrix functionPattern = version.buildFunctionPattern();
+	std::vector<PointI> stream;
+	stream.reserve(8 * version.totalCodewords());
 	bool readingUp = true;
-	int bitsRead = 0;
-	int dimension = bitMatrix.height();
+	int dimension = layout.dimension;
 	// Read columns in pairs, from right to left
 	for (int x = dimension - 1; x > 0; x -= 2) {
 		// Skip whole column with vertical timing pattern.
@@ -78,28 +80,83 @@ static ByteArray ReadQRCodewords(const BitMatrix& bitMatrix, const Version& vers
 			for (int col = 0; col < 2; col++) {
 				int xx = x - col;
 				// Ignore bits covered by the function pattern
-				if (!functionPattern.get(xx, y)) {
-					// Read a bit
-					AppendBit(currentByte,
-							  GetDataMaskBit(formatInfo.dataMask, xx, y) != getBit(bitMatrix, xx, y, formatInfo.isMirrored));
-					// If we've made a whole byte, save it off
-					if (++bitsRead % 8 == 0)
-						result.push_back(std::exchange(currentByte, 0));
-				}
+				if (!functionPattern.get(xx, y))
+					stream.emplace_back(xx, y);
 			}
 		}
 		readingUp = !readingUp; // switch directions
 	}
-	if (Size(result) != version.totalCodewords())
-		return {};
+	// The remainder bits after the last codeword are never read
+	stream.resize(8 * version.totalCodewords());
+
+	// All blocks have the same amount of data, except that the last n (where n may be 0) have 1 more byte.
+	auto& ecBlocks = version.ecBlocksForLevel(ecLevel);
+	for (auto& ecBlock : ecBlocks.blockArray())
+		for (int i = 0; i < ecBlock.count; i++)
+			layout.numDataCodewords.push_back(ecBlock.dataCodewords);
+	layout.numBlocks = Size(layout.numDataCodewords);
+	layout.blockOffsets.push_back(0);
+	for (int numData : layout.numDataCodewords) {
+		layout.blockOffsets.push_back(layout.blockOffsets.back() + numData + ecBlocks.codewordsPerBlock);
+		layout.totalDataCodewords += numData;
+	}
+
+	// Map the interleaved codeword order onto the RS block order. See 8.6 of JISX0510:2004 (p.37).
+	std::vector<int> order; // block order position of every interleaved codeword
+	order.reserve(version.totalCodewords());
+	const int maxNumData = layout.numDataCodewords.back();
+	for (int i = 0; i < maxNumData; i++)
+		for (int j = 0; j < layout.numBlocks; j++)
+			if (i < layout.numDataCodewords[j])
+				order.push_back(layout.blockOffsets[j] + i);
+	for (int i = 0; i < ecBlocks.codewordsPerBlock; i++)
+		for (int j = 0; j < layout.numBlocks; j++)
+			order.push_back(layout.blockOffsets[j] + layout.numDataCodewords[j] + i);
+
+	layout.modules.resize(stream.size());
+	layout.mirroredModules.resize(stream.size());
+	for (auto& mask : layout.masks)
+		mask.resize(version.totalCodewords());
+	for (int i = 0; i < Size(order); i++) {
+		for (int k = 0; k < 8; k++) {
+			auto p = stream[8 * i + k];
+			layout.modules[8 * order[i] + k] = p.y * dimension + p.x;
+			layout.mirroredModules[8 * order[i] + k] = p.x * dimension + p.y;
+			for (int m = 0; m < Size(layout.masks); m++)
+				AppendBit(layout.masks[m][order[i]], GetDataMaskBit(m, p.x, p.y));
+		}
+	}
 
-	return result;
+	return layout;
 }
 
-ByteArray ReadCodewords(const BitMatrix& bitMatrix, const Version& version, const FormatInformation& formatInfo)
+const CodewordLayout& GetCodewordLayout(const Version& version, ErrorCorrectionLevel ecLevel)
 {
-	if (version.type() == Type::Model2) return ReadQRCodewords(bitMatrix, version, formatInfo);
-	else return {};
+	// Misdetected candidates may come with any version, so keep every layout that was needed once.
+	// The layout is returned by reference, so the cache must outlive the call even when ZX_THREAD_LOCAL is empty.
+	thread_local std::array<std::unique_ptr<CodewordLayout>, 40 * 4> cache;
+	auto& layout = cache[(version.versionNumber() - 1) * 4 + static_cast<int>(ecLevel)];
+	if (!layout)
+		layout = std::make_unique<CodewordLayout>(BuildCodewordLayout(version, ecLevel));
+	return *layout;
+}
+
+void ReadBlockCodewords(const BitMatrix& bitMatrix, const CodewordLayout& layout, int block, const FormatInformation& formatInfo,
+						std::vector<int>& codewords)
+{
+	const int first = layout.blockOffsets[block];
+	const int last = layout.blockOffsets[block + 1];
+	const auto* bits = bitMatrix.row(0).begin();
+	const int* modules = (formatInfo.isMirrored ? layout.mirroredModules : layout.modules).data() + 8 * first;
+	const uint8_t* mask = layout.masks[formatInfo.dataMask].data() + first;
+
+	codewords.resize(last - first);
+	for (auto& codeword : codewords) {
+		int value = 0;
+		for (int k = 0; k < 8; k++)
+			AppendBit(value, bits[*modules++] != 0);
+		codeword = value ^ *mask++;
+	}
 }
 
 } // namespace ZXing::QRCode
@@ -9,15 +9,16 @@
 
 #include "BitMatrix.h"
 #include "BitSource.h"
+#include "ByteArray.h"
 #include "GenericGF.h"
 #include "QRBitMatrixParser.h"
 #include "QRCodecMode.h"
-#include "QRDataBlock.h"
 #include "QRFormatInformation.h"
 #include "QRVersion.h"
 #include "ReedSolomonDecoder.h"
 #include "StructuredAppend.h"
 #include "ZXAlgorithms.h"
+#include "ZXConfig.h"
 #include "ZXTestSupport.h"
 
 #include <algorithm>
@@ -30,22 +31,25 @@ namespace ZXing::QRCode {
 * <p>Given data and error-correction codewords received, possibly corrupted by errors, attempts to
 * correct the errors in-place using Reed-Solomon error correction.</p>
 *
-* @param codewordBytes data and error correction codewords
+* @param codewords data and error correction codewords
 * @param numDataCodewords number of codewords that are data bytes
 * @return false if error correction fails
 */
-static bool CorrectErrors(ByteArray& codewordBytes, int numDataCodewords)
+static bool CorrectErrors(std::vector<int>& codewords, int numDataCodewords)
 {
-	// First read into an array of ints
-	std::vector<int> codewordsInts(codewordBytes.begin(), codewordBytes.end());
-
-	int numECCodewords = Size(codewordBytes) - numDataCodewords;
-	if (!ReedSolomonDecode(GenericGF::QRCodeField256(), codewordsInts, numECCodewords))
+	int numECCodewords = Size(codewords) - numDataCodewords;
+	if (!qr_count) return ReedSolomonDecode(GenericGF::QRCodeField256(), codewords, numECCodewords);
+
+	TraceZone zone("ReedSolomonDecode");
+	ZX_THREAD_LOCAL std::vector<int> received;
+	received.assign(codewords.begin(), codewords.end());
+	if (!ReedSolomonDecode(GenericGF::QRCodeField256(), codewords, numECCodewords)) {
+		qr_count("rs_failures", 1);
 		return false;
-
-	// Copy back into array of bytes -- only need to worry about the bytes that were data
-	// We don't care about errors in the error-correction codewords
-	std::copy_n(codewordsInts.begin(), numDataCodewords, codewordBytes.begin());
+	}
+	long long corrected = 0;
+	for (int i = 0; i < Size(codewords); ++i) corrected += codewords[i] != received[i];
+	qr_count("rs_corrections", corrected);
 	return true;
 }
 
@@ -80,7 +84,7 @@ bool IsEndOfStream(const BitSource& bits, const Version& version)
 * <p>See ISO 18004:2006, 6.4.3 - 6.4.7</p>
 */
 ZXING_EXPORT_TEST_ONLY
-std::vector<uint8_t> DecodeBitStream(ByteArray&& bytes, const Version& version)
+std::vector<uint8_t> DecodeBitStream(const ByteArray& bytes, const Version& version)
 {
 	if (!version.isModel2()) return {};
 
@@ -99,7 +103,10 @@ std::vector<uint8_t> DecodeBitStream(ByteArray&& bytes, const Version& version)
 				mode = CodecModeForBits(bits.readBits(modeBitLength), version.type());
 
 			const int count = bits.readBits(CharacterCountBits(mode, version.versionNumber()));
-			if (mode == CodecMode::BYTE) for (int i = 0; i < count; i++) result.push_back(narrow_cast<uint8_t>(bits.readBits(8)));
+			if (mode == CodecMode::BYTE) {
+				result.reserve(result.size() + std::min(count, bits.available() / 8)); // count is not trusted beyond the data present
+				for (int i = 0; i < count; i++) result.push_back(narrow_cast<uint8_t>(bits.readBits(8)));
+			}
 			else return {};
 		}
 	} catch (...) { return {}; }
@@ -120,33 +127,30 @@ std::vector<uint8_t> Decode(const BitMatrix& bits)
 	const Version& version = *pversion;
     if (!version.isModel2()) return {};
 
-	// Read codewords
-	ByteArray codewords = ReadCodewords(bits, version, formatInfo);
-	if (codewords.empty()) return {};
-
-	// Separate into data blocks
-	std::vector<DataBlock> dataBlocks = DataBlock::GetDataBlocks(codewords, version, formatInfo.ecLevel);
-	if (dataBlocks.empty()) return {};
+	// Read the codewords of each block straight from the matrix, already de-interleaved
+	const CodewordLayout& layout = GetCodewordLayout(version, formatInfo.ecLevel);
+	if (bits.width() != layout.dimension) return {};
 
-	// Count total number of data bytes
-	const auto op = [](auto totalBytes, const auto& dataBlock){ return totalBytes + dataBlock.numDataCodewords();};
-	const auto totalBytes = Reduce(dataBlocks, int{}, op);
-	ByteArray resultBytes(totalBytes);
+	ZX_THREAD_LOCAL ByteArray resultBytes;
+	resultBytes.assign(layout.totalDataCodewords, 0);
 	auto resultIterator = resultBytes.begin();
+	ZX_THREAD_LOCAL std::vector<int> codewords;
 
 	// Error-correct and copy data blocks together into a stream of bytes
-	for (auto& dataBlock : dataBlocks)
+	for (int i = 0; i < layout.numBlocks; i++)
 	{
-		ByteArray& codewordBytes = dataBlock.codewords();
-		int numDataCodewords = dataBlock.numDataCodewords();
+		ReadBlockCodewords(bits, layout, i, formatInfo, codewords);
+		int numDataCodewords = layout.numDataCodewords[i];
 
-		if (!CorrectErrors(codewordBytes, numDataCodewords)) return {};
+		if (!CorrectErrors(codewords, numDataCodewords)) return {};
 
-		resultIterator = std::copy_n(codewordBytes.begin(), numDataCodewords, resultIterator);
+		// Only need to worry about the bytes that were data, we don't care about errors in the error-correction codewords
+		resultIterator = std::transform(codewords.begin(), codewords.begin() + numDataCodewords, resultIterator,
+										[](int c) { return narrow_cast<uint8_t>(c); });
 	}
 
 	// Decode the contents of that stream of bytes
-	auto result = DecodeBitStream(std::move(resultBytes), version);
+	auto result = DecodeBitStream(resultBytes, version);
 
 	if(!qr_ecc.has_value() && !qr_version.has_value() && !result.empty()) {
 		qr_ecc = static_cast<int>(formatInfo.ecLevel);
@@ -17,12 +17,12 @@
 #include "QRVersion.h"
 #include "Quadrilateral.h"
 #include "RegressionLine.h"
+#include "ZXConfig.h"
 
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <iterator>
-#include <map>
 #include <utility>
 #include <vector>
 
@@ -41,7 +41,7 @@ PatternView FindPattern(const PatternView& view)
 	});
 }
 
-std::vector<ConcentricPattern> FindFinderPatterns(const BitMatrix& image, bool tryHarder)
+void FindFinderPatterns(const BitMatrix& image, bool tryHarder, FinderPatterns& res, int moduleSize)
 {
 	constexpr int MIN_SKIP         = 3;           // 1 pixel/module times 3 modules/center
 	constexpr int MAX_MODULES_FAST = 20 * 4 + 17; // support up to version 20 for mobile clients
@@ -54,10 +54,14 @@ std::vector<ConcentricPattern> FindFinderPatterns(const BitMatrix& image, bool t
 	int skip = (3 * height) / (4 * MAX_MODULES_FAST);
 	if (skip < MIN_SKIP || tryHarder)
 		skip = MIN_SKIP;
+	// With a known module size, step one module at a time: a center rotated by about 45 degrees only shows the 1:1:3:1:1
+	// ratio on rows close to its middle, so the 3 module height of an upright center can not be relied upon.
+	if (moduleSize > 0)
+		skip = std::max(MIN_SKIP, moduleSize);
 
-	std::vector<ConcentricPattern> res;
+	res.clear();
 	[[maybe_unused]] int N = 0;
-	PatternRow row;
+	ZX_THREAD_LOCAL PatternRow row;
 
 	for (int y = skip - 1; y < height; y += skip) {
 		GetPatternRow(image, y, row, false);
@@ -82,20 +86,20 @@ std::vector<ConcentricPattern> FindFinderPatterns(const BitMatrix& image, bool t
 			next.extend();
 		}
 	}
-
-	return res;
 }
 
 /**
  * @brief GenerateFinderPatternSets
  * @param patterns list of ConcentricPattern objects, i.e. found finder pattern squares
- * @return list of plausible finder pattern sets, sorted by decreasing plausibility
+ * @param res list of plausible finder pattern sets, sorted by decreasing plausibility
  */
-FinderPatternSets GenerateFinderPatternSets(FinderPatterns& patterns)
+void GenerateFinderPatternSets(FinderPatterns& patterns, FinderPatternSets& res)
 {
 	std::sort(patterns.begin(), patterns.end(), [](const auto& a, const auto& b) { return a.size < b.size; });
 
-	auto sets            = std::multimap<double, FinderPatternSet>();
+	// sets ordered by ascending d, sets with equal d keep their insertion order (like a multimap)
+	ZX_THREAD_LOCAL std::vector<std::pair<double, FinderPatternSet>> sets;
+	sets.clear();
 	auto squaredDistance = [](const auto* a, const auto* b) {
 		// The scaling of the distance by the b/a size ratio is a very coarse compensation for the shortening effect of
 		// the camera projection on slanted symbols. The fact that the size of the finder pattern is proportional to the
@@ -167,22 +171,19 @@ FinderPatternSets GenerateFinderPatternSets(FinderPatterns& patterns)
 				// arbitrarily limit the number of potential sets
 				// (this has performance implications while limiting the maximal number of detected symbols)
 				const auto setSizeLimit = 256;
-				if (sets.size() < setSizeLimit || sets.crbegin()->first > d) {
-					sets.emplace(d, FinderPatternSet{*a, *b, *c});
+				if (sets.size() < setSizeLimit || sets.back().first > d) {
+					auto pos = std::upper_bound(sets.begin(), sets.end(), d, [](double d, const auto& s) { return d < s.first; });
+					sets.emplace(pos, d, FinderPatternSet{*a, *b, *c});
 					if (sets.size() > setSizeLimit)
-						sets.erase(std::prev(sets.end()));
+						sets.pop_back();
 				}
 			}
 		}
 	}
 
-	// convert from multimap to vector
-	FinderPatternSets res;
-	res.reserve(sets.size());
+	res.clear();
 	for (auto& [d, s] : sets)
 		res.push_back(s);
-
-	return res;
 }
 
 static double EstimateModuleSize(const BitMatrix& image, ConcentricPattern a, ConcentricPattern b)
@@ -220,10 +221,10 @@ static DimensionEstimate EstimateDimension(const BitMatrix& image, ConcentricPat
 	return {dimension + error, moduleSize, std::abs(error)};
 }
 
-static RegressionLine TraceLine(const BitMatrix& image, PointF p, PointF d, int edge)
+static void TraceLine(const BitMatrix& image, PointF p, PointF d, int edge, RegressionLine& line)
 {
 	BitMatrixCursorF cur(image, p, d - p);
-	RegressionLine line;
+	line.reset();
 	line.setDirectionInward(cur.back());
 
 	// collect points inside the black line -> backup on 3rd edge
@@ -252,8 +253,6 @@ static RegressionLine TraceLine(const BitMatrix& image, PointF p, PointF d, int
 	}
 
 	line.evaluate(1.0, true);
-
-	return line;
 }
 
 // estimate how tilted the symbol is (return value between 1 and 2, see also above)
@@ -318,7 +317,7 @@ static const Version* ReadVersion(const BitMatrix& image, int dimension, const P
 	return Version::DecodeVersionInformation(bits[0], bits[1]);
 }
 
-DetectorResult SampleQR(const BitMatrix& image, const FinderPatternSet& fp)
+DetectorResult SampleQR(const BitMatrix& image, const FinderPatternSet& fp, BitMatrix&& reuse)
 {
 	auto top  = EstimateDimension(image, fp.tl, fp.tr);
 	auto left = EstimateDimension(image, fp.tl, fp.bl);
@@ -339,10 +338,11 @@ DetectorResult SampleQR(const BitMatrix& image, const FinderPatternSet& fp)
 
 	// generate 4 lines: outer and inner edge of the 1 module wide black line between the two outer and the inner
 	// (tl) finder pattern
-	auto bl2 = TraceLine(image, fp.bl, fp.tl, 2);
-	auto bl3 = TraceLine(image, fp.bl, fp.tl, 3);
-	auto tr2 = TraceLine(image, fp.tr, fp.tl, 2);
-	auto tr3 = TraceLine(image, fp.tr, fp.tl, 3);
+	ZX_THREAD_LOCAL RegressionLine bl2, bl3, tr2, tr3;
+	TraceLine(image, fp.bl, fp.tl, 2, bl2);
+	TraceLine(image, fp.bl, fp.tl, 3, bl3);
+	TraceLine(image, fp.tr, fp.tl, 2, tr2);
+	TraceLine(image, fp.tr, fp.tl, 3, tr3);
 
 	if (bl2.isValid() && tr2.isValid() && bl3.isValid() && tr3.isValid()) {
 		// intersect both outer and inner line pairs and take the center point between the two intersection points
@@ -378,13 +378,14 @@ DetectorResult SampleQR(const BitMatrix& image, const FinderPatternSet& fp)
 		}
 #if 1
 		auto& apM = version->alignmentPatternCenters(); // alignment pattern positions in modules
-		auto apP = Matrix<std::optional<PointF>>(Size(apM), Size(apM)); // found/guessed alignment pattern positions in pixels
+		ZX_THREAD_LOCAL Matrix<std::optional<PointF>> apP; // found/guessed alignment pattern positions in pixels
+		apP.reset(Size(apM), Size(apM));
 		const int N = Size(apM) - 1;
 
 		// project the alignment pattern at module coordinates x/y to pixel coordinate based on current mod2Pix
 		auto projectM2P = [&mod2Pix, &apM](int x, int y) { return mod2Pix(centered(PointI(apM[x], apM[y]))); };
 
-		auto findInnerCornerOfConcentricPattern = [&image, &apP, &projectM2P](int x, int y, const ConcentricPattern& fp) {
+		auto findInnerCornerOfConcentricPattern = [&image, &projectM2P](int x, int y, const ConcentricPattern& fp) {
 			auto pc = *apP.set(x, y, projectM2P(x, y));
 			if (auto fpQuad = FindConcentricPatternCorners(image, fp, fp.size, 2))
 				for (auto c : *fpQuad)
@@ -420,20 +421,21 @@ DetectorResult SampleQR(const BitMatrix& image, const FinderPatternSet& fp)
 					continue;
 
 				// find the two closest valid alignment pattern pixel positions both horizontally and vertically
-				std::vector<PointF> hori, verti;
-				for (int i = 2; i < 2 * N + 2 && Size(hori) < 2; ++i) {
+				PointF hori[2], verti[2];
+				int nh = 0, nv = 0;
+				for (int i = 2; i < 2 * N + 2 && nh < 2; ++i) {
 					int xi = x + i / 2 * (i%2 ? 1 : -1);
 					if (0 <= xi && xi <= N && apP(xi, y))
-						hori.push_back(*apP(xi, y));
+						hori[nh++] = *apP(xi, y);
 				}
-				for (int i = 2; i < 2 * N + 2 && Size(verti) < 2; ++i) {
+				for (int i = 2; i < 2 * N + 2 && nv < 2; ++i) {
 					int yi = y + i / 2 * (i%2 ? 1 : -1);
 					if (0 <= yi && yi <= N && apP(x, yi))
-						verti.push_back(*apP(x, yi));
+						verti[nv++] = *apP(x, yi);
 				}
 
 				// if we found 2 each, intersect the two lines that are formed by connecting the point pairs
-				if (Size(hori) == 2 && Size(verti) == 2) {
+				if (nh == 2 && nv == 2) {
 					auto guessed = intersect(RegressionLine(hori[0], hori[1]), RegressionLine(verti[0], verti[1]));
 					auto found = LocateAlignmentPattern(image, moduleSize, guessed);
 					// search again near that intersection and if the search fails, use the intersection
@@ -455,7 +457,8 @@ DetectorResult SampleQR(const BitMatrix& image, const FinderPatternSet& fp)
 			}
 
 		// assemble a list of region-of-interests based on the found alignment pattern pixel positions
-		ROIs rois;
+		ZX_THREAD_LOCAL ROIs rois;
+		rois.clear();
 		for (int y = 0; y < N; ++y)
 			for (int x = 0; x < N; ++x) {
 				int x0 = apM[x], x1 = apM[x + 1], y0 = apM[y], y1 = apM[y + 1];
@@ -464,11 +467,11 @@ DetectorResult SampleQR(const BitMatrix& image, const FinderPatternSet& fp)
 													 {*apP(x, y), *apP(x + 1, y), *apP(x + 1, y + 1), *apP(x, y + 1)}}});
 			}
 
-		return SampleGrid(image, dimension, dimension, rois);
+		return SampleGrid(image, dimension, dimension, rois, std::move(reuse));
 #endif
 	}
 
-	return SampleGrid(image, dimension, dimension, mod2Pix);
+	return SampleGrid(image, dimension, dimension, mod2Pix, std::move(reuse));
 }
 
 } // namespace ZXing::QRCode
@@ -11,6 +11,8 @@
 #include "BitHacks.h"
 #include "ZXAlgorithms.h"
 
+#include <array>
+
 namespace ZXing::QRCode {
 
 static uint32_t MirrorBits(uint32_t bits)
@@ -18,7 +20,7 @@ static uint32_t MirrorBits(uint32_t bits)
 	return BitHacks::Reverse(bits) >> 17;
 }
 
-static FormatInformation FindBestFormatInfo(const std::vector<uint32_t>& masks, const std::vector<uint32_t>& bits)
+static FormatInformation FindBestFormatInfo(const std::array<uint32_t, 3>& masks, const std::array<uint32_t, 4>& bits)
 {
 	// See ISO 18004:2015, Annex C, Table C.1
 	constexpr uint32_t MODEL2_MASKED_PATTERNS[] = {
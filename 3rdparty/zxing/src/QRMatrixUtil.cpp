@@ -8,12 +8,17 @@
 
 #include "BitArray.h"
 #include "BitHacks.h"
+#include "ByteArray.h"
 #include "QRDataMask.h"
 #include "QRErrorCorrectionLevel.h"
 #include "QRVersion.h"
+#include "ZXConfig.h"
 
+#include <array>
+#include <cstdint>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace ZXing::QRCode {
 
@@ -250,12 +255,23 @@ static void EmbedVersionInfo(const Version& version, TritMatrix& matrix)
 	}
 }
 
-// Embed "dataBits" using "getMaskPattern". On success, modify the matrix and return true.
-// For debugging purposes, it skips masking process if "getMaskPattern" is -1.
-// See 8.7 of JISX0510:2004 (p.38) for how to embed data bits.
-static void EmbedDataBits(const BitArray& dataBits, int maskPattern, TritMatrix& matrix)
+// Function patterns and data module placement only depend on version and EC level. A qrb run uses the same
+// version and EC level for every symbol, so they are built once and every symbol (and every mask candidate in
+// ChooseMaskPattern) becomes a copy of the template plus a scatter of the data bits.
+struct MatrixTemplate
 {
-	int bitIndex = 0;
+	int versionNumber = 0;
+	ErrorCorrectionLevel ecLevel = ErrorCorrectionLevel::Invalid;
+	std::array<TritMatrix, NUM_MASK_PATTERNS> patterns; // all function patterns, incl. the type info of each mask
+	std::vector<int> dataModules;                         // matrix offsets of the data modules in placement order
+	std::vector<uint8_t> maskBits;                        // bit i is set if mask pattern i flips the data module
+};
+
+// Collect the data module positions in placement order. See 8.7 of JISX0510:2004 (p.38).
+static void CollectDataModules(const TritMatrix& matrix, MatrixTemplate& tpl)
+{
+	tpl.dataModules.clear();
+	tpl.maskBits.clear();
 	int direction = -1;
 	// Start from the right bottom cell.
 	int x = matrix.width() - 1;
@@ -271,16 +287,11 @@ static void EmbedDataBits(const BitArray& dataBits, int maskPattern, TritMatrix&
 				if (!matrix.get(xx, y).isEmpty()) {
 					continue;
 				}
-				// Padding bit. If there is no bit left, we'll fill the left cells with 0, as described
-				// in 8.4.9 of JISX0510:2004 (p. 24).
-				bool bit = bitIndex < dataBits.size() ? dataBits.get(bitIndex) : false;
-				++bitIndex;
-
-				// Skip masking if mask_pattern is -1.
-				if (maskPattern != -1 && GetDataMaskBit(maskPattern, xx, y)) {
-					bit = !bit;
-				}
-				matrix.set(xx, y, bit);
+				uint8_t mask = 0;
+				for (int maskPattern = 0; maskPattern < NUM_MASK_PATTERNS; ++maskPattern)
+					mask |= GetDataMaskBit(maskPattern, xx, y) << maskPattern;
+				tpl.dataModules.push_back(y * matrix.width() + xx);
+				tpl.maskBits.push_back(mask);
 			}
 			y += direction;
 		}
@@ -288,17 +299,17 @@ static void EmbedDataBits(const BitArray& dataBits, int maskPattern, TritMatrix&
 		y += direction;
 		x -= 2;  // Move to the left.
 	}
-	// All bits should be consumed.
-	if (bitIndex < dataBits.size()) {
-		throw std::invalid_argument("Not all bits consumed: " + std::to_string(bitIndex) + '/' + std::to_string(dataBits.size()));
-	}
 }
 
-// Build 2D matrix of QR Code from "dataBits" with "ecLevel", "version" and "getMaskPattern". On
-// success, store the result in "matrix" and return true.
-void BuildMatrix(const BitArray& dataBits, ErrorCorrectionLevel ecLevel, const Version& version, int maskPattern, TritMatrix& matrix)
+static const MatrixTemplate& GetMatrixTemplate(ErrorCorrectionLevel ecLevel, const Version& version)
 {
-	matrix.clear();
+	// The template is returned by reference, so it needs storage that outlives the call even when ZX_THREAD_LOCAL is empty
+	thread_local MatrixTemplate tpl;
+	if (tpl.versionNumber == version.versionNumber() && tpl.ecLevel == ecLevel)
+		return tpl;
+
+	int dimension = version.dimension();
+	TritMatrix matrix(dimension, dimension);
 	// Let's get started with embedding big squares at corners.
 	EmbedPositionDetectionPatternsAndSeparators(matrix);
 	// Then, embed the dark dot at the left bottom corner.
@@ -307,12 +318,60 @@ void BuildMatrix(const BitArray& dataBits, ErrorCorrectionLevel ecLevel, const V
 	EmbedPositionAdjustmentPatterns(version, matrix);
 	// Timing patterns should be embedded after position adj. patterns.
 	EmbedTimingPatterns(matrix);
-	// Type information appear with any version.
-	EmbedTypeInfo(ecLevel, maskPattern, matrix);
+	// Type information appear with any version, the cells are the same for every mask.
+	EmbedTypeInfo(ecLevel, 0, matrix);
 	// Version info appear if version >= 7.
 	EmbedVersionInfo(version, matrix);
-	// Data should be embedded at end.
-	EmbedDataBits(dataBits, maskPattern, matrix);
+	// Every cell still empty is a data module.
+	CollectDataModules(matrix, tpl);
+
+	for (int maskPattern = 0; maskPattern < NUM_MASK_PATTERNS; ++maskPattern) {
+		tpl.patterns[maskPattern] = matrix.copy();
+		EmbedTypeInfo(ecLevel, maskPattern, tpl.patterns[maskPattern]);
+	}
+
+	tpl.versionNumber = version.versionNumber();
+	tpl.ecLevel = ecLevel;
+	return tpl;
+}
+
+// Embed "codewords" using "maskPattern" into a copy of the function pattern template. On success, store the
+// result in "matrix". The remainder bits are filled with 0, as described in 8.4.9 of JISX0510:2004 (p. 24).
+static void EmbedDataBits(const ByteArray& codewords, int maskPattern, const MatrixTemplate& tpl, TritMatrix& matrix)
+{
+	const int numModules = Size(tpl.dataModules);
+	const int numBits = 8 * Size(codewords);
+	// All bits should be consumed.
+	if (numBits > numModules) {
+		throw std::invalid_argument("Not all bits consumed: " + std::to_string(numModules) + '/' + std::to_string(numBits));
+	}
+
+	auto& pattern = tpl.patterns[maskPattern];
+	if (matrix.width() != pattern.width() || matrix.height() != pattern.height())
+		matrix = pattern.copy();
+	else
+		std::copy(pattern.begin(), pattern.end(), matrix.begin());
+
+	Trit* out = matrix.begin();
+	const int* pos = tpl.dataModules.data();
+	const uint8_t* mask = tpl.maskBits.data();
+	int i = 0;
+	for (auto byte : codewords)
+		for (int bit = 7; bit >= 0; --bit, ++i)
+			out[pos[i]] = Trit(bool((byte >> bit) & 1) != bool((mask[i] >> maskPattern) & 1));
+	for (; i < numModules; ++i)
+		out[pos[i]] = Trit(bool((mask[i] >> maskPattern) & 1));
+}
+
+// Build 2D matrix of QR Code from the interleaved "codewords" with "ecLevel", "version" and "maskPattern". On
+// success, store the result in "matrix".
+void BuildMatrix(const ByteArray& codewords, ErrorCorrectionLevel ecLevel, const Version& version, int maskPattern, TritMatrix& matrix)
+{
+	if (maskPattern < 0 || maskPattern >= NUM_MASK_PATTERNS) {
+		throw std::invalid_argument("Invalid mask pattern");
+	}
+
+	EmbedDataBits(codewords, maskPattern, GetMatrixTemplate(ecLevel, version), matrix);
 }
 
 } // namespace ZXing::QRCode
@@ -11,6 +11,8 @@
 #include "Quadrilateral.h"
 #include "QRDetector.h"
 #include "QRDecoder.h"
+#include "ZXAlgorithms.h"
+#include "ZXConfig.h"
 
 #include <utility>
 
@@ -18,21 +20,49 @@ namespace ZXing::QRCode {
 
 std::pair<std::vector<std::vector<uint8_t>>, std::vector<QuadrilateralI>> Reader::decode(const BinaryBitmap& image, const bool single) const
 {
-	auto binImg = image.getBitMatrix();
+	const BitMatrix* binImg;
+	{
+		TraceZone zone("binarize");
+		binImg = image.getBitMatrix();
+	}
 	if (binImg == nullptr) return {};
 
 	std::pair<std::vector<std::vector<uint8_t>>, std::vector<QuadrilateralI>> result;
 
-	auto FP = FindFinderPatterns(*binImg, true);
-	for (const auto& pattern : GenerateFinderPatternSets(FP)) {
-		const auto detectorResult = SampleQR(*binImg, pattern);
-		const auto decoderResult = Decode(detectorResult.bits());
+	// Scratch of the detector, kept per thread so that only the decoded symbols allocate once the buffers have grown
+	ZX_THREAD_LOCAL FinderPatterns FP;
+	ZX_THREAD_LOCAL FinderPatternSets sets;
+	ZX_THREAD_LOCAL BitMatrix grid; // storage of the sampled grid, handed from one attempt to the next
+	{
+		TraceZone zone("FindFinderPatterns");
+		FindFinderPatterns(*binImg, _opts.tryHarder(), FP, _opts.moduleSize());
+	}
+	if (qr_count) qr_count("finder_patterns", Size(FP));
+	{
+		TraceZone zone("GenerateFinderPatternSets");
+		GenerateFinderPatternSets(FP, sets);
+	}
+	for (const auto& pattern : sets) {
+		if (qr_count) qr_count("finder_sets_tried", 1);
+		auto detectorResult = [&] {
+			TraceZone zone("SampleQR");
+			return SampleQR(*binImg, pattern, std::move(grid));
+		}();
+		if (!detectorResult.isValid())
+			continue;
 
-		if (detectorResult.isValid() && !decoderResult.empty()) {
-			result.first.push_back(decoderResult);
+		auto decoderResult = [&] {
+			TraceZone zone("Decode");
+			return Decode(detectorResult.bits());
+		}();
+		if (!decoderResult.empty()) {
+			result.first.push_back(std::move(decoderResult));
 			result.second.push_back(detectorResult.position());
-			if (single) return result;
 		}
+		grid = std::move(detectorResult).bits();
+
+		if (single && !result.first.empty())
+			return result;
 	}
 	
 	return result;
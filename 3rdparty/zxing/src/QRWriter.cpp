@@ -25,9 +25,9 @@ Writer::Writer()
 	  _maskPattern(-1)
 {}
 
-BitMatrix Writer::encode(const BitArray& contents, int width, int height) const
+BitMatrix Writer::encode(std::span<const uint8_t> contents, int width, int height) const
 {
-	if (contents.size() == 0) {
+	if (contents.empty()) {
 		throw std::invalid_argument("Found empty contents");
 	}
 
@@ -39,4 +39,13 @@ BitMatrix Writer::encode(const BitArray& contents, int width, int height) const
 	return Inflate(std::move(code.matrix), width, height, _margin);
 }
 
+BitMatrix Writer::encode(std::span<const uint8_t> contents) const
+{
+	if (contents.empty()) {
+		throw std::invalid_argument("Found empty contents");
+	}
+
+	return std::move(Encode(contents, _ecLevel, _version, _maskPattern).matrix);
+}
+
 } // namespace ZXing::QRCode
@@ -17,13 +17,13 @@
 namespace ZXing {
 
 static bool
-RunEuclideanAlgorithm(const GenericGF& field, std::vector<int>&& rCoefs, GenericGFPoly& sigma, GenericGFPoly& omega)
+RunEuclideanAlgorithm(const GenericGF& field, const std::vector<int>& rCoefs, GenericGFPoly& sigma, GenericGFPoly& omega)
 {
 	int R = Size(rCoefs); // == numECCodeWords
-	GenericGFPoly r(field, std::move(rCoefs));
+	ZX_THREAD_LOCAL GenericGFPoly r, q, rLast;
+	r.setField(field).setCoefficients(rCoefs);
 	GenericGFPoly& tLast = omega.setField(field);
 	GenericGFPoly& t = sigma.setField(field);
-	ZX_THREAD_LOCAL GenericGFPoly q, rLast;
 
 	rLast.setField(field);
 	q.setField(field);
@@ -63,35 +63,33 @@ RunEuclideanAlgorithm(const GenericGF& field, std::vector<int>&& rCoefs, Generic
 	t.multiplyByMonomial(inverse);
 	r.multiplyByMonomial(inverse);
 
-	// sigma is t
-	omega = std::move(r);
+	// sigma is t, omega is r (swapped rather than moved, so that no polynomial gives up its storage)
+	swap(omega, r);
 	return true;
 }
 
-static std::vector<int>
-FindErrorLocations(const GenericGF& field, const GenericGFPoly& errorLocator)
+static bool
+FindErrorLocations(const GenericGF& field, const GenericGFPoly& errorLocator, std::vector<int>& res)
 {
 	// This is a direct application of Chien's search
 	int numErrors = errorLocator.degree();
-	std::vector<int> res;
-	res.reserve(numErrors);
+	res.clear();
 
 	for (int i = 1; i < field.size() && Size(res) < numErrors; i++)
 		if (errorLocator.evaluateAt(i) == 0)
 			res.push_back(field.inverse(i));
 
-	if (Size(res) != numErrors)
-		return {}; // Error locator degree does not match number of roots
-
-	return res;
+	// Error locator degree must match the number of roots
+	return !res.empty() && Size(res) == numErrors;
 }
 
-static std::vector<int>
-FindErrorMagnitudes(const GenericGF& field, const GenericGFPoly& errorEvaluator, const std::vector<int>& errorLocations)
+static void
+FindErrorMagnitudes(const GenericGF& field, const GenericGFPoly& errorEvaluator, const std::vector<int>& errorLocations,
+					std::vector<int>& res)
 {
 	// This is directly applying Forney's Formula
 	int s = Size(errorLocations);
-	std::vector<int> res(s);
+	res.resize(s);
 	for (int i = 0; i < s; ++i) {
 		int xiInverse = field.inverse(errorLocations[i]);
 		int denom = 1;
@@ -102,15 +100,17 @@ FindErrorMagnitudes(const GenericGF& field, const GenericGFPoly& errorEvaluator,
 		if (field.generatorBase() != 0)
 			res[i] = field.multiply(res[i], xiInverse);
 	}
-	return res;
 }
 
 bool
 ReedSolomonDecode(const GenericGF& field, std::vector<int>& message, int numECCodeWords)
 {
-	GenericGFPoly poly(field, message);
+	// all scratch is kept per thread, so decoding a block does not allocate once the buffers have grown
+	ZX_THREAD_LOCAL GenericGFPoly poly;
+	poly.setField(field).setCoefficients(message);
 
-	std::vector<int> syndromes(numECCodeWords);
+	ZX_THREAD_LOCAL std::vector<int> syndromes;
+	syndromes.resize(numECCodeWords);
 	for (int i = 0; i < numECCodeWords; i++)
 		syndromes[numECCodeWords - 1 - i] = poly.evaluateAt(field.exp(i + field.generatorBase()));
 
@@ -120,14 +120,14 @@ ReedSolomonDecode(const GenericGF& field, std::vector<int>& message, int numECCo
 
 	ZX_THREAD_LOCAL GenericGFPoly sigma, omega;
 
-	if (!RunEuclideanAlgorithm(field, std::move(syndromes), sigma, omega))
+	if (!RunEuclideanAlgorithm(field, syndromes, sigma, omega))
 		return false;
 
-	auto errorLocations = FindErrorLocations(field, sigma);
-	if (errorLocations.empty())
+	ZX_THREAD_LOCAL std::vector<int> errorLocations, errorMagnitudes;
+	if (!FindErrorLocations(field, sigma, errorLocations))
 		return false;
 
-	auto errorMagnitudes = FindErrorMagnitudes(field, omega, errorLocations);
+	FindErrorMagnitudes(field, omega, errorLocations, errorMagnitudes);
 
 	int msgLen = Size(message);
 	for (int i = 0; i < Size(errorLocations); ++i) {
@@ -0,0 +1,227 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <format>
+#include <random>
+#include <chrono>
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <ranges>
+#include <cmath>
+
+#include <opencv2/imgproc.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+#include <qrb/qr.h>
+#include <qrb/page.h>
+#include <qrb/qrb.h>
+
+namespace {
+    constexpr std::array versions = {10, 20, 30};
+    constexpr std::array eccs = {0, 1, 2};
+    constexpr std::array<std::pair<int, int>, 2> grids = {{{2, 3}, {4, 6}}};
+
+    constexpr uint32_t seed = 20240601; // 固定种子，每次运行生成相同的语料与拍摄参数
+    constexpr double background = 90.0; // 页面周围背景的灰度
+    constexpr int jpeg_quality = 75;
+
+    std::mt19937 rng;
+    std::vector<std::array<double, 3>> samples; // 每次运行的每页像素数、每页模块数与每页识别秒数，用于拟合自动布局的耗时系数
+
+    double uniform(const double a, const double b) { return std::uniform_real_distribution(a, b)(rng); }
+
+    double elapsed(const std::chrono::steady_clock::time_point beg) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - beg).count(); }
+
+    template <class F> void quiet(F&& fn) { // 屏蔽qrb的进度输出，标准输出只保留JSON
+        std::ostringstream sink;
+        auto* const old = std::cout.rdbuf(sink.rdbuf());
+        fn();
+        std::cout.rdbuf(old);
+    }
+
+    std::vector<uint8_t> load(const fs::path& file) {
+        std::ifstream input(file, std::ios::binary);
+        return {std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()};
+    }
+
+    std::pair<std::vector<uint8_t>, size_t> capture(const cv::Mat& page) { // 模拟拍摄：背景与缩放、透视、光照不均、模糊、噪声，再以JPEG重压缩
+        cv::Mat canvas;
+        const int pad = std::max(page.cols, page.rows) / 20;
+        cv::copyMakeBorder(page, canvas, pad, pad, pad, pad, cv::BORDER_CONSTANT, cv::Scalar(background));
+
+        const double scale = uniform(0.8, 1.0);
+        cv::resize(canvas, canvas, {}, scale, scale, cv::INTER_AREA);
+
+        const auto w = static_cast<float>(canvas.cols - 1), h = static_cast<float>(canvas.rows - 1);
+        const auto j = 0.02 * std::min(w, h); // 角点偏移不超过短边的2%
+        const std::array<cv::Point2f, 4> src = {{{0.0f, 0.0f}, {w, 0.0f}, {w, h}, {0.0f, h}}};
+        std::array<cv::Point2f, 4> dst{};
+        for (int i = 0; i < 4; ++i) dst[i] = src[i] + cv::Point2f(static_cast<float>(uniform(-j, j)), static_cast<float>(uniform(-j, j)));
+        cv::Mat warp;
+        cv::warpPerspective(canvas, warp, cv::getPerspectiveTransform(src.data(), dst.data()), canvas.size(), cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar(background));
+
+        cv::Mat img;
+        warp.convertTo(img, CV_32F);
+        const double angle = uniform(0.0, 2.0 * CV_PI), depth = uniform(0.1, 0.35); // 沿随机方向线性变暗
+        const double dx = std::cos(angle) / img.cols, dy = std::sin(angle) / img.rows;
+        for (int y = 0; y < img.rows; ++y) {
+            auto* p = img.ptr<float>(y);
+            for (int x = 0; x < img.cols; ++x) p[x] *= static_cast<float>(1.0 - depth * (0.5 + 0.5 * (x * dx + y * dy)));
+        }
+
+        cv::GaussianBlur(img, img, {}, uniform(0.4, 1.0));
+        cv::Mat noise(img.size(), CV_32F);
+        cv::randn(noise, 0.0, uniform(2.0, 8.0));
+        img += noise;
+
+        cv::Mat result;
+        img.convertTo(result, CV_8U);
+        std::vector<uint8_t> binary;
+        cv::imencode(".jpg", result, binary, {cv::IMWRITE_JPEG_QUALITY, jpeg_quality});
+        return {binary, result.total()};
+    }
+
+    std::string run(const fs::path& input, const fs::path& root, const int version, const int ecc, const int col, const int row) {
+        const auto enc_dir = root / "encode", cap_dir = root / "capture", dec_dir = root / "decode";
+        for (const auto& dir : {enc_dir, cap_dir, dec_dir}) fs::remove_all(dir);
+
+        const auto size = static_cast<double>(fs::file_size(input));
+        bool ok = false;
+        uint32_t cap = 0;
+        auto beg = std::chrono::steady_clock::now();
+        quiet([&] {
+            if (!(ok = qrb::config(input, enc_dir, col, row, version, ecc))) return;
+            cap = qrb::qr::cap();
+            qrb::write();
+            qrb::clean();
+        });
+        if (!ok) return {};
+        const auto encode_s = elapsed(beg);
+
+        // 每页都模拟拍摄，并按原图的格点采样结果记录各网格单元的二维码内容，按行优先排列，末页未填满的单元不在其中
+        std::vector<std::pair<fs::path, std::vector<std::vector<uint8_t>>>> pages;
+        double pixels = 0.0;
+        uint32_t last = 0;
+        for (const auto& entry : fs::directory_iterator(enc_dir / "file")) last = std::max(last, static_cast<uint32_t>(std::stoul(entry.path().stem().string())));
+        fs::create_directories(cap_dir / "file");
+        for (uint32_t n = 1; n <= last; ++n) {
+            const auto page = enc_dir / "file" / (std::to_string(n) + ".png");
+            const auto shot = cap_dir / "file" / (std::to_string(n) + ".jpg");
+            const auto [binary, px] = capture(cv::imread(page.string(), cv::IMREAD_GRAYSCALE));
+            pixels += static_cast<double>(px);
+            std::ofstream(shot, std::ios::binary).write(reinterpret_cast<const char*>(binary.data()), static_cast<int64_t>(binary.size()));
+
+            std::vector<std::vector<uint8_t>> cells;
+            quiet([&] { qrb::qr::fresh(); cells = qrb::page::read(page); });
+            pages.emplace_back(shot, std::move(cells));
+        }
+
+        // 逐页识别拍摄图像，统计吞吐；识别结果在计时结束后与原图逐单元比对
+        std::vector<std::vector<std::vector<uint8_t>>> shots;
+        beg = std::chrono::steady_clock::now();
+        quiet([&] {
+            qrb::qr::fresh();
+            for (const auto& shot : pages | std::views::keys) shots.push_back(qrb::page::read(shot));
+        });
+        const auto decode_s = elapsed(beg);
+
+        // 按网格位置统计识别率，便于发现边角或透视较大处的单元
+        std::vector<size_t> hit(static_cast<size_t>(col) * row, 0), seen(hit.size(), 0);
+        size_t symbols = 0, expected = 0;
+        for (size_t p = 0; p < pages.size(); ++p) {
+            const auto& cells = pages[p].second;
+            for (size_t k = 0; k < cells.size() && k < hit.size(); ++k) {
+                ++seen[k];
+                if (std::ranges::find(shots[p], cells[k]) != shots[p].end()) ++hit[k];
+            }
+            expected += cells.size();
+        }
+        for (const auto h : hit) symbols += h;
+        std::string grid;
+        for (int r = 0; r < row; ++r) {
+            grid += r == 0 ? "[" : ", [";
+            for (int c = 0; c < col; ++c) {
+                const auto k = static_cast<size_t>(r) * col + c;
+                grid += std::format("{}{:.4f}", c == 0 ? "" : ", ", seen[k] == 0 ? 0.0 : static_cast<double>(hit[k]) / static_cast<double>(seen[k]));
+            }
+            grid += "]";
+        }
+        const auto n = 4 * version + 17;
+        const auto page_px = pixels / static_cast<double>(pages.size()), page_modules = static_cast<double>(col) * row * n * n;
+        samples.push_back({page_px, page_modules, decode_s / static_cast<double>(pages.size())});
+
+        // 完整解码并与原文件比对
+        beg = std::chrono::steady_clock::now();
+        quiet([&] {
+            if (!qrb::config(cap_dir / "file", dec_dir)) return;
+            qrb::read();
+            qrb::clean();
+        });
+        const auto roundtrip_s = elapsed(beg);
+        const bool restored = fs::exists(dec_dir / input.filename()) && load(dec_dir / input.filename()) == load(input);
+
+        return std::format(
+            R"({{"version": {}, "ecc": "{}", "grid": "{}x{}", "pages": {}, "symbols": {}, "page_px": {:.0f}, "page_modules": {:.0f}, "encode_mb_s": {:.3f}, "pages_s": {:.3f}, "symbols_s": {:.1f}, "decode_mb_s": {:.3f}, "success": {:.4f}, "cell_success": [{}], "roundtrip": {}, "roundtrip_s": {:.3f}}})",
+            version, "LMQH"[ecc], col, row, pages.size(), expected, page_px, page_modules, size / encode_s / 1e6,
+            static_cast<double>(pages.size()) / decode_s, static_cast<double>(symbols) / decode_s, static_cast<double>(symbols) * cap / decode_s / 1e6,
+            expected == 0 ? 0.0 : static_cast<double>(symbols) / static_cast<double>(expected), grid, restored ? "true" : "false", roundtrip_s
+        );
+    }
+
+    std::pair<double, double> fit() { // 以最小二乘拟合每页识别耗时 = 像素数 * cost_px + 模块数 * cost_module，单位纳秒，系数非负
+        double xx = 0.0, xy = 0.0, yy = 0.0, xt = 0.0, yt = 0.0;
+        for (const auto& [x, y, t] : samples) {
+            xx += x * x; xy += x * y; yy += y * y;
+            xt += x * t; yt += y * t;
+        }
+        if (xx == 0.0 || yy == 0.0) return {};
+
+        const auto det = xx * yy - xy * xy;
+        if (det > 1e-9 * xx * yy) { // 网格与版本使像素数与模块数不完全成比例时两者可分离
+            const auto px = (xt * yy - yt * xy) / det, module = (yt * xx - xt * xy) / det;
+            if (px >= 0.0 && module >= 0.0) return {px * 1e9, module * 1e9};
+        }
+        const auto px = xt / xx, module = yt / yy; // 近似共线或出现负系数时只保留残差较小的单项
+        double rx = 0.0, ry = 0.0;
+        for (const auto& [x, y, t] : samples) {
+            rx += (t - px * x) * (t - px * x);
+            ry += (t - module * y) * (t - module * y);
+        }
+        return rx <= ry ? std::pair{px * 1e9, 0.0} : std::pair{0.0, module * 1e9};
+    }
+}
+
+#ifdef WIN32
+int wmain(const int argc, const wchar_t* argv[]) {
+#else
+int main(const int argc, const char* argv[]) {
+#endif
+    const auto root = argc > 1 ? fs::path(argv[1]) : fs::temp_directory_path() / "qrb_bench";
+    const auto size = argc > 2 ? std::stoul(fs::path(argv[2]).string()) * 1024 : 64 * 1024; // 语料大小，单位KiB
+    const auto costs = argc > 3 ? fs::path(argv[3]) : fs::path(); // 拟合的耗时系数文件，供qrb --cost载入
+
+    rng.seed(seed);
+    cv::theRNG().state = seed;
+    fs::create_directories(root);
+
+    const auto input = root / "corpus.bin"; // 随机数据不可压缩，块数与文件大小成正比
+    std::vector<uint8_t> corpus(size);
+    for (auto& b : corpus) b = static_cast<uint8_t>(rng());
+    std::ofstream(input, std::ios::binary).write(reinterpret_cast<const char*>(corpus.data()), static_cast<int64_t>(corpus.size()));
+
+    std::cout << "{\"size\": " << size << ", \"runs\": [" << std::flush;
+    bool first = true;
+    for (const auto v : versions) for (const auto e : eccs) for (const auto& [col, row] : grids) {
+        std::cerr << std::format("QR {}-{} {}x{}", v, "LMQH"[e], col, row) << std::endl;
+        const auto line = run(input, root, v, e, col, row);
+        if (line.empty()) continue;
+        std::cout << (first ? "\n  " : ",\n  ") << line << std::flush;
+        first = false;
+    }
+    const auto [cost_px, cost_module] = fit();
+    std::cout << std::format("\n], \"cost_px\": {:.3f}, \"cost_module\": {:.3f}}}", cost_px, cost_module) << std::endl;
+    if (!costs.empty() && cost_px + cost_module > 0.0) std::ofstream(costs) << std::format("cost_px {}\ncost_module {}\n", cost_px, cost_module);
+
+    return 0;
+}
@@ -0,0 +1,269 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <format>
+#include <random>
+#include <chrono>
+#include <vector>
+#include <map>
+#include <string>
+#include <functional>
+#include <algorithm>
+#include <filesystem>
+#include <limits>
+#include <cstdlib>
+#include <new>
+
+#include <BitMatrix.h>
+#include <ByteArray.h>
+#include <ImageView.h>
+#include <GenericGF.h>
+#include <GlobalHistogramBinarizer.h>
+#include <ReedSolomonDecoder.h>
+#include <ReedSolomonEncoder.h>
+#include <QRBitMatrixParser.h>
+#include <QRDetector.h>
+#include <QREncoder.h>
+#include <QREncodeResult.h>
+#include <QRFormatInformation.h>
+#include <QRMaskUtil.h>
+#include <QRMatrixUtil.h>
+#include <QRVersion.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+    size_t alloc_count = 0, alloc_bytes = 0; // 全局operator new的调用次数与字节数，仅单线程使用
+}
+
+void* operator new(const std::size_t size) {
+    ++alloc_count;
+    alloc_bytes += size;
+    if (void* const p = std::malloc(size == 0 ? 1 : size)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { ::operator delete(p); }
+
+namespace {
+    using namespace ZXing;
+    using namespace ZXing::QRCode;
+
+    constexpr uint32_t seed = 20240601; // 固定种子，每个版本生成相同的数据与噪声
+    constexpr auto ecc = ErrorCorrectionLevel::Medium;
+    constexpr int module_px = 4;  // 每个模块的像素数
+    constexpr int quiet_zone = 4; // 静区宽度，单位为模块
+    constexpr auto min_time = std::chrono::milliseconds(20); // 每项至少计时的时长
+
+    struct sample {
+        double ns = 0, bytes = 0, allocs = 0;
+    };
+
+    // 暴露受保护的固定阈值二值化
+    struct binarizer : GlobalHistogramBinarizer {
+        using GlobalHistogramBinarizer::GlobalHistogramBinarizer;
+        using BinaryBitmap::binarize;
+    };
+
+    std::mt19937 rng;
+    volatile size_t sink = 0; // 累加每次调用的结果，防止被优化掉
+
+    sample measure(const std::function<size_t()>& op) {
+        sink = sink + op(); // 预热，填充布局表、生成多项式等惰性缓存
+
+        const auto count = alloc_count, bytes = alloc_bytes;
+        sink = sink + op();
+        sample result{0, static_cast<double>(alloc_bytes - bytes), static_cast<double>(alloc_count - count)};
+
+        for (uint64_t n = 1;;) {
+            const auto beg = std::chrono::steady_clock::now();
+            for (uint64_t i = 0; i < n; ++i) sink = sink + op();
+            const auto t = std::chrono::steady_clock::now() - beg;
+            if (t >= min_time) {
+                result.ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(t).count()) / static_cast<double>(n);
+                return result;
+            }
+            const auto ratio = static_cast<double>(min_time.count()) * 1e6 / std::max<double>(1.0, static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(t).count()));
+            n = std::max(n * 2, static_cast<uint64_t>(static_cast<double>(n) * ratio * 1.2)); // 按本轮耗时估计达到最短时长所需的次数
+        }
+    }
+
+    // 名称与版本 -> 基线结果，文件不存在时为空
+    std::map<std::pair<std::string, int>, sample> load(const std::string& file) {
+        std::map<std::pair<std::string, int>, sample> baseline;
+        std::ifstream input(file);
+        std::string name;
+        int version;
+        sample s;
+        while (input >> name >> version >> s.ns >> s.bytes >> s.allocs) baseline[{name, version}] = s;
+        return baseline;
+    }
+
+    // 按版本生成一个M级纠错的随机符号，渲染成带噪声的灰度图像，并依次测量解码与编码各环节
+    bool run(const int v, std::vector<std::pair<std::string, sample>>& results) {
+        const auto* const version = Version::Model2(v);
+        const auto& layout = GetCodewordLayout(*version, ecc);
+
+        std::vector<uint8_t> data(layout.totalDataCodewords - 3); // 扣除字节模式的模式指示与长度字段
+        for (auto& b : data) b = static_cast<uint8_t>(rng());
+        const auto symbol = Encode(data, ecc, v).matrix;
+
+        const int size = (symbol.width() + 2 * quiet_zone) * module_px;
+        const auto page = Inflate(symbol.copy(), size, size, quiet_zone * module_px);
+        std::vector<uint8_t> gray(static_cast<size_t>(size) * size);
+        std::uniform_int_distribution noise(-24, 24);
+        for (int y = 0; y < size; ++y) for (int x = 0; x < size; ++x) gray[static_cast<size_t>(y) * size + x] = static_cast<uint8_t>((page.get(x, y) ? 48 : 208) + noise(rng));
+
+        const binarizer image(ImageView(gray.data(), size, size, ImageFormat::Lum));
+        const auto bits = image.getBitMatrix()->copy();
+        FinderPatterns patterns, found;
+        FindFinderPatterns(bits, false, patterns);
+        auto copy = patterns;
+        FinderPatternSets sets, generated;
+        GenerateFinderPatternSets(copy, sets);
+        if (sets.empty()) return false;
+        const auto sampled = SampleQR(bits, sets.front()).bits().copy();
+        const auto format = ReadFormatInformation(sampled);
+        if (!format.isValid() || format.ecLevel != ecc) return false;
+
+        // 各纠错块的完整码字，数据在前
+        std::vector<std::vector<int>> blocks(layout.numBlocks);
+        std::vector<int> num_ec(layout.numBlocks);
+        for (int i = 0; i < layout.numBlocks; ++i) {
+            ReadBlockCodewords(sampled, layout, i, format, blocks[i]);
+            num_ec[i] = layout.blockOffsets[i + 1] - layout.blockOffsets[i] - layout.numDataCodewords[i];
+        }
+        auto received = blocks; // 每块注入纠错能力一半的错误
+        for (int i = 0; i < layout.numBlocks; ++i) for (int k = 0; k < num_ec[i] / 4; ++k) received[i][rng() % received[i].size()] ^= static_cast<int>(rng() % 255 + 1);
+
+        ByteArray codewords(version->totalCodewords());
+        for (auto& b : codewords) b = static_cast<uint8_t>(rng());
+
+        const auto& field = GenericGF::QRCodeField256();
+        ReedSolomonEncoder encoder(field);
+        std::vector<uint16_t> row;
+        std::vector<int> work, block;
+        BitMatrix black, grid; // 输出矩阵在各次调用间复用，与解码路径一致
+        TritMatrix matrix(version->dimension(), version->dimension());
+
+        const std::vector<std::pair<std::string, std::function<size_t()>>> kernels = {
+            {"getBlackMatrix", [&] {
+                image.getBlackMatrix(black);
+                return static_cast<size_t>(black.width());
+            }},
+            {"binarize", [&] {
+                image.binarize(128, black);
+                return static_cast<size_t>(black.width());
+            }},
+            {"GetPatternRow", [&] {
+                size_t n = 0;
+                for (int r = 0; r < bits.height(); ++r) {
+                    GetPatternRow(bits, r, row, false);
+                    n += row.size();
+                }
+                return n;
+            }},
+            {"FindFinderPatterns", [&] {
+                FindFinderPatterns(bits, false, found);
+                return found.size();
+            }},
+            {"GenerateFinderPatternSets", [&] {
+                copy = patterns;
+                GenerateFinderPatternSets(copy, generated);
+                return generated.size();
+            }},
+            {"SampleGrid", [&] {
+                grid = SampleQR(bits, sets.front(), std::move(grid)).bits();
+                return static_cast<size_t>(grid.width());
+            }},
+            {"ReadCodewords", [&] {
+                size_t n = 0;
+                for (int i = 0; i < layout.numBlocks; ++i) {
+                    ReadBlockCodewords(sampled, layout, i, format, block);
+                    n += block.size();
+                }
+                return n;
+            }},
+            {"ReedSolomonDecode", [&] {
+                size_t n = 0;
+                for (int i = 0; i < layout.numBlocks; ++i) {
+                    work.assign(received[i].begin(), received[i].end());
+                    n += ReedSolomonDecode(field, work, num_ec[i]);
+                }
+                return n;
+            }},
+            {"ReedSolomonEncode", [&] {
+                size_t n = 0;
+                for (int i = 0; i < layout.numBlocks; ++i) {
+                    work.assign(blocks[i].begin(), blocks[i].end());
+                    encoder.encode(work, num_ec[i]);
+                    n += static_cast<size_t>(work.back());
+                }
+                return n;
+            }},
+            {"ChooseMaskPattern", [&] { // 与编码器内部的选择相同：逐个掩码构建矩阵并计算惩罚分
+                int best = 0, min_penalty = std::numeric_limits<int>::max();
+                for (int mask = 0; mask < 8; ++mask) {
+                    BuildMatrix(codewords, ecc, *version, mask, matrix);
+                    if (const int penalty = MaskUtil::CalculateMaskPenalty(matrix); penalty < min_penalty) {
+                        min_penalty = penalty;
+                        best = mask;
+                    }
+                }
+                return static_cast<size_t>(best);
+            }},
+            {"Inflate", [&] { return static_cast<size_t>(Inflate(symbol.copy(), size, size, quiet_zone * module_px).width()); }},
+        };
+        for (const auto& [name, op] : kernels) results.emplace_back(name, measure(op));
+
+        return true;
+    }
+}
+
+#ifdef WIN32
+int wmain(const int argc, const wchar_t* argv[]) {
+#else
+int main(const int argc, const char* argv[]) {
+#endif
+    int first = 1, last = 40;
+    std::string save, compare;
+    std::vector<std::string> rest;
+    for (int i = 1; i < argc; ++i) {
+        const auto arg = fs::path(argv[i]).string();
+        if ((arg == "--save" || arg == "--compare") && i + 1 < argc) (arg == "--save" ? save : compare) = fs::path(argv[++i]).string();
+        else rest.push_back(arg);
+    }
+    if (rest.size() == 2) {
+        first = std::stoi(rest[0]);
+        last = std::stoi(rest[1]);
+    } else if (!rest.empty()) {
+        std::cerr << "Usage: qrb_kernels [<first> <last>] [--save <file>] [--compare <file>]" << std::endl;
+        return 1;
+    }
+    first = std::clamp(first, 1, 40);
+    last = std::clamp(last, first, 40);
+
+    const auto baseline = load(compare);
+    std::ofstream output;
+    if (!save.empty()) output.open(save);
+
+    std::cout << std::format("{:<26}{:>4}{:>14}{:>12}{:>10}", "kernel", "ver", "ns/op", "B/op", "allocs/op") << (baseline.empty() ? "" : "      delta") << std::endl;
+    rng.seed(seed);
+    for (int v = first; v <= last; ++v) {
+        std::vector<std::pair<std::string, sample>> results;
+        if (!run(v, results)) {
+            std::cerr << std::format("QR {}: sample symbol not detected, skipped", v) << std::endl;
+            continue;
+        }
+        for (const auto& [name, s] : results) {
+            std::cout << std::format("{:<26}{:>4}{:>14.1f}{:>12.0f}{:>10.0f}", name, v, s.ns, s.bytes, s.allocs);
+            if (const auto it = baseline.find({name, v}); it != baseline.end()) std::cout << std::format("{:>+10.1f}%", (s.ns / it->second.ns - 1.0) * 100.0);
+            std::cout << std::endl;
+            if (output.is_open()) output << std::format("{} {} {:.1f} {:.0f} {:.0f}\n", name, v, s.ns, s.bytes, s.allocs);
+        }
+    }
+
+    return 0;
+}
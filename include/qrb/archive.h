@@ -0,0 +1,45 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace qrb::archive {
+    struct entry {
+        std::string name;    // 相对路径，UTF-8编码，以/分隔
+        uint64_t offset = 0; // 在数据流中的偏移
+        uint64_t length = 0; // 存储字节数
+        uint64_t size = 0;   // 原始字节数
+        uint8_t codec = 0;   // 0为存储，1为deflate
+    };
+
+    // 将目录下的全部常规文件打包为以name为根名称的归档，目录在前，成员各自压缩，无收益时存储；返回归档总字节数，失败时返回0
+    // 仅目录置于内存，成员分段压缩并暂存于临时文件，存储的成员在读出时才从源文件读取
+    uint64_t pack(const fs::path& input_dir, const std::u8string& name, bool compress);
+
+    // 按顺序读出归档数据流，返回读出的字节数
+    size_t read(std::span<uint8_t> data);
+
+    // 已读出的存储成员中，源文件在打包后大小改变的路径；读出的数据与目录不符，恢复后的内容错误
+    std::vector<fs::path> changed();
+
+    // 释放打包状态并删除临时文件
+    void clean();
+
+    // 由数据流开头至少14字节判断是否为归档，返回目录的总字节数，非归档返回0
+    uint64_t size(std::span<const uint8_t> prefix);
+
+    // 解析完整的目录，返回根名称与各成员，格式错误时返回空；成员解包到输出目录下以根名称命名的子目录
+    std::pair<std::string, std::vector<entry>> list(std::span<const uint8_t> directory);
+
+    // 成员是否与指定名称匹配，相对路径或文件名相同均可
+    bool match(const entry& item, const std::string& name);
+
+    // 解压成员数据并写到输出目录下的相对路径，输出超过item.size时立即停止，失败时不保留该成员
+    bool extract(const entry& item, std::span<const uint8_t> data, const fs::path& output_dir);
+}
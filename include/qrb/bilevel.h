@@ -0,0 +1,19 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <functional>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace qrb::bilevel {
+    // 按行生成1位像素，高位在前，1为黑色，行号依次递增，同一缓冲在行间复用
+    using row_fn = std::function<void(int y, std::span<uint8_t> row)>;
+
+    // 是否支持该扩展名的二值图像格式
+    bool support(const std::string& ext);
+
+    // 按扩展名写1位PNG或PBM图像，不经过8位灰度图像
+    bool write(const fs::path& file, int width, int height, const row_fn& fill);
+}
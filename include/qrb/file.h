@@ -1,13 +1,14 @@
 #pragma once
 
+#include <optional>
 #include <filesystem>
 #include <unordered_map>
 
 namespace fs = std::filesystem;
 
 namespace qrb::file {
-    // 配置编码模式下的文件处理
-    bool config(const fs::path& input_file, const fs::path& output_dir);
+    // 配置编码模式下的文件处理，可选压缩文件数据，输入为目录时打包为归档，为"-"时从标准输入流式读取且不压缩
+    bool config(const fs::path& input_file, const fs::path& output_dir, bool compress);
 
     // 配置解码模式下的文件处理
     bool config(const fs::path& input_dir, const fs::path& output_dir, const fs::path& ecc_dir);
@@ -15,27 +16,63 @@ namespace qrb::file {
     // 关闭文件流
     void clean();
 
+    // 开启增量编码，key为决定页面图像的渲染参数，为空表示关闭；需在编码模式的config之前调用，此时时间戳取输入的修改时间
+    void incremental(const std::string& key);
+
+    // 开启写页后的校验，每页写出后读回文件按格点解码并与原始数据比对，矢量格式采样模块矩阵，增量编码跳过的页不校验
+    void verify(bool enable);
+
+    // 已校验的页数与未通过校验的页，路径相对输出文件夹
+    std::pair<uint64_t, std::vector<fs::path>> verified();
+
+    // 当前二维码容量下，文件数据与元数据能否全部以文件块序号表示，编码模式的config之后有效
+    bool fits();
+
     // 需处理字节总数或文件总数
     uint64_t total();
 
-    // 剩余的字节总数或文件总数
+    // 剩余的字节总数或文件总数，流式读取未读完时只保证不小于一块的容量
     uint64_t remain();
 
+    // 是否从标准输入流式读取，此时总字节数随读取增长
+    bool streaming();
+
     // 读指定长度字节到缓冲
     uint64_t read(std::span<uint8_t> data, uint64_t offset, uint64_t length);
 
-    // 写页原始数据到文件
+    // 写页原始数据到文件，增量编码时跳过内容未变的页
     void write(std::span<const uint8_t> data, const fs::path& file_name, bool is_ecc);
 
     // 读文件的原始页数据
     std::pair<std::vector<std::vector<uint8_t>>, bool> read();
 
+    // 写完整的源数据到文件，用于喷泉码恢复的结果
+    void restore(std::span<const uint8_t> data);
+
     // 写数据到文件的指定序号对应的偏移位置
     void write(std::span<const uint8_t> data, uint64_t offset, uint32_t index, bool is_ecc);
 
-    // 解码并应用附加的元数据
+    // 解码并应用附加的元数据，压缩的文件数据在此解压，归档在此解包全部成员
     std::tuple<uint64_t, uint32_t, fs::path> metadata();
 
-    // 奇偶校验修复缺失的数据
-    void repair(std::array<std::unordered_map<uint32_t, bool>, 2>& index, bool has_last);
+    // 文件图像中页号对应的图像序号，不存在时返回total()
+    uint64_t find(uint32_t number);
+
+    // 读指定序号图像的原始页数据
+    std::pair<std::vector<std::vector<uint8_t>>, bool> read(uint64_t i);
+
+    // 文件块在数据流中的偏移
+    uint64_t offset(uint32_t index);
+
+    // 数据流中指定偏移所在的文件块序号
+    uint32_t locate(uint64_t pos);
+
+    // 读已解码数据流的指定区间，超出已写入部分时截断
+    std::vector<uint8_t> load(uint64_t offset, uint64_t length);
+
+    // 关闭并删除解码过程的中间文件
+    void discard();
+
+    // 奇偶校验或纠删码修复缺失的数据，纠删码可恢复尾块时同时确定尾块序号
+    void repair(std::array<std::unordered_map<uint32_t, bool>, 2>& index, std::optional<uint32_t>& last_index);
 }
\ No newline at end of file
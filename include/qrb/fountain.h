@@ -0,0 +1,37 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cstdint>
+
+namespace qrb::fountain {
+    // 编码时整体读入源数据以随机组合修复符号，解码时保留全部符号求解，源数据总字节数上限为64 MiB
+    constexpr uint64_t max_total = 64ULL << 20;
+
+    // 配置编码，按源数据总字节数与二维码容量划分源块，返回源块数量，0表示容量不足或超过max_total
+    uint32_t config(uint64_t total, uint32_t cap);
+
+    // 源块数量
+    uint32_t count();
+
+    // 种子最大值，即可生成的符号数量上限
+    uint32_t max();
+
+    // 编码指定种子的符号，前count()个种子为源块本身，其后为随机组合的修复符号；源数据无需补齐到整块
+    void encode(uint32_t seed, std::span<const uint8_t> source, std::span<uint8_t> symbol);
+
+    // 判断块是否为喷泉码符号
+    bool check(std::span<const uint8_t> block);
+
+    // 接收一个符号，重复或与已接收符号不属于同一数据时忽略
+    bool insert(std::span<const uint8_t> block);
+
+    // 已接收的不同符号数量
+    uint32_t received();
+
+    // 尝试由已接收的符号恢复源数据
+    bool solve(std::vector<uint8_t>& source);
+
+    // 清空接收状态
+    void clean();
+}
@@ -8,14 +8,49 @@
 namespace fs = std::filesystem;
 
 namespace qrb::page {
-    void config(int num_col, int num_row);
+    // 配置网格，彩色页在青、品红、黄三个平面各放一层二维码，页底附加校准色块
+    void config(int num_col, int num_row, bool colour = false);
 
-    // 每页能容量的二维码个数
+    // 每页能容量的二维码个数，彩色页为网格单元数的三倍
     int cap();
 
+    // 解码参数，默认值为经验值，可由图像集搜索
+    struct params {
+        float tolerance = 1.0f / 16.0f; // 网格中心聚类与间距判断的误差容忍度，应大于0且小于1
+        double roi_scale = 1.15;        // 识别区域扩展系数，应大于1且小于1.5，否则会干扰掩码工作
+        int roi_tries = 16;             // 每个网格单元尝试的识别区域数，1只试原始区域，2另试四边均扩展的区域，16试所有扩展组合
+        int passes = 3;                 // 识别轮数，1只整体识别，2再按网格识别，3再按修正后的网格识别
+        int filter_d = 5;               // 双边滤波的邻域直径，0表示不滤波
+        double filter_sigma = 30.0;     // 双边滤波的颜色与空间标准差
+        int binarizer = 0;              // 0由ZXing按全局直方图二值化，1预先按Otsu阈值二值化，2预先按局部均值自适应二值化
+        bool try_harder = true;         // 逐3行查找定位图案，为false时按图像高度跳行，更快但可能漏检较小的二维码
+        int band = 0;                   // 分带识别时每带的网格行数，带间另重叠一行，只限制单次识别的工作区，整幅灰度图像仍在内存中；0表示整幅识别
+    };
+
+    // 设置解码参数，超出范围时返回false
+    bool tune(const params& p);
+
+    // 当前的解码参数
+    const params& tuned();
+
+    // 是否能以该扩展名的格式写页图像
+    bool writable(const std::string& ext);
+
     // 将一页数据编码并写到文件
     void write(std::span<const uint8_t> data, const fs::path& file);
 
-    // 读取文件并解码页原始数据
-    std::vector<std::vector<uint8_t>> read(const fs::path& file);
+    // 按已知格点解码刚写出的页，逐个与原始数据比对，全部一致时返回true
+    // 光栅格式从file读回后采样，彩色页先分离各平面；矢量格式无法读回，采样生成它的模块矩阵
+    bool check(std::span<const uint8_t> data, const fs::path& file);
+
+    // 结束多页文档的输出
+    void close();
+
+    // 读取文件并解码页原始数据，自动识别彩色页，已识别个数达到expect时提前结束，0表示不限
+    // 未经缩放与拍摄的黑白页按格点直接采样，无法按此解码时再走完整的识别流程
+    // 分带识别时直接读为灰度图像，由灰度图像底部的校准色块检测彩色页并拒绝，返回空并计入rejected
+    std::vector<std::vector<uint8_t>> read(const fs::path& file, size_t expect = 0);
+
+    // 分带识别时拒绝的彩色页数
+    uint64_t rejected();
 }
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+// 运行时开启的性能剖析，按线程记录各阶段耗时与计数，结束时输出汇总并写Chrome trace-event JSON
+// 未开启时每个计时区间只有一次判断，不分配内存
+namespace qrb::probe {
+    // 开启记录，trace为输出文件路径，无法写入时返回false
+    // pmu为true时在Linux上经perf_event_open为每个线程读取周期、指令、缓存与分支未命中计数，归到各计时区间，不可用时只记录耗时
+    bool enable(const fs::path& trace, bool pmu = false);
+
+    // 是否已开启
+    bool enabled();
+
+    // 累加计数器，同名计数器跨线程合计；按线程归到最内层的计时区间，区间结束时随事件写出一次，不逐次记录
+    void count(const char* name, int64_t value = 1);
+
+    // 作用域计时，名称须为字符串常量；file的文件名写入trace事件的参数，仅在开启时构造
+    struct zone {
+        explicit zone(const char* name);
+        zone(const char* name, const fs::path& file);
+        ~zone();
+
+        zone(const zone&) = delete;
+        zone& operator=(const zone&) = delete;
+
+    private:
+        bool open = false; // 区间记录在线程的栈上，未开启时为false
+    };
+
+    // 输出各阶段耗时汇总与计数器，并写trace文件，之后关闭各线程的硬件计数器；须在工作线程结束后调用
+    void dump();
+}
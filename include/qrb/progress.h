@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+// 编解码进度，计数可由任意线程原子更新，终端按固定间隔重绘，标准输出不是终端时不绘制
+// 可选按JSON Lines写进度与结果事件，供外部调度程序读取
+namespace qrb::progress {
+    // 开启事件输出，file为输出文件路径，无法写入时返回false
+    bool events(const fs::path& file);
+
+    // 开始一个阶段，total为总量，0表示总量未知，unit为计量单位，名称与单位须为字符串常量
+    void start(const char* stage, uint64_t total, const char* unit);
+
+    // 累加已完成量，同时清零当前单元内的进度
+    void advance(uint64_t n = 1);
+
+    // 设置已完成量
+    void set(uint64_t done);
+
+    // 当前单元内已完成的比例，用于细化单个耗时较长的单元，如一幅图像的各识别区域
+    void part(double fraction);
+
+    // 设置已找到的块数，写入进度事件
+    void found(uint64_t n);
+
+    // 结束当前阶段，清除终端上的进度行并写结束事件
+    void finish();
+
+    // 写一个事件，fields为已编码的JSON成员，如"\"found\": 3"，可为空
+    void emit(const char* type, const std::string& fields = {});
+}
@@ -5,17 +5,30 @@
 #include <opencv2/core.hpp>
 
 namespace qrb::qr {
-    void config(int qr_version, int qr_ecc);
+    // 配置版本、纠错等级与每模块的像素边长
+    void config(int qr_version, int qr_ecc, int qr_unit = 4);
     
     // 刷新ZXing状态
     void fresh();
 
+    // 设置定位图案的查找策略，try_harder为false时按图像高度估计跳过的行数
+    void strategy(bool try_harder);
+
+    // 设置待识别图像中模块边长像素的估计值，定位图案查找按1个模块的行距扫描，0表示未知，此时按查找策略决定
+    void hint(int unit_px);
+
     // 含留白的二维码缩放后的边长像素
     int px();
 
     // 二维码图像之间的间隔像素
     int sp();
 
+    // 单个模块缩放后的边长像素
+    int unit();
+
+    // 二维码四周留白的像素
+    int border();
+
     // 扩展前的ROI区域与无留白二维码区域的边长比例
     float ratio();
 
@@ -25,6 +38,14 @@ namespace qrb::qr {
     // 编码单个二维码
     void encode(std::span<const uint8_t> data, cv::Mat& img);
 
+    // 编码单个二维码为不含留白、未缩放的模块矩阵，非零为黑色
+    void matrix(std::span<const uint8_t> data, cv::Mat& modules);
+
     // 解码单个或多个二维码
     std::pair<std::vector<std::vector<uint8_t>>, std::vector<cv::Rect>> decode(const cv::Mat& img, bool single);
+
+    // 按已知格点采样模块中心并解码单个二维码，用于像素精确的数字图像，不做二值化与定位图案查找
+    // origin为不含留白的二维码左上角，dim为每边模块数，unit为模块边长像素，灰度小于128为黑色，失败时返回空
+    // adopt为true时与decode相同，以首个识别结果的版本与纠错等级更新配置
+    std::vector<uint8_t> sample(const cv::Mat& img, cv::Point origin, int dim, int unit, bool adopt = false);
 }
\ No newline at end of file
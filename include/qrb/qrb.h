@@ -12,6 +12,60 @@ namespace qrb{
     // 配置编码参数
     bool config(const fs::path& input_file, const fs::path& output_dir, int num_col, int num_row, int qr_version, int qr_ecc, int file_ecc = 0);
     
+    // 设置自动布局的纸张尺寸、打印分辨率与每模块的最小像素边长，纸张为a3、a4、a5、letter、legal或以毫米为单位的宽x高
+    bool paper(const std::string& size, int dpi, int module_px);
+
+    // 按文件大小与纸张自动选择版本、纠错等级、网格与缩放倍数，使页数最少且解码耗时较低，再配置编码参数
+    bool plan(const fs::path& input_file, const fs::path& output_dir, int file_ecc = 0);
+
+    // 设置编码输出的页图像格式，默认为1位PNG
+    bool format(const std::string& ext);
+
+    // 使用喷泉码代替奇偶校验，修复符号数量为源块数量的指定百分比
+    bool rateless(int percent);
+
+    // 使用跨页交织的RS纠删码代替奇偶校验，每组k个数据符号与m个校验符号
+    bool erasure(int k, int m);
+
+    // 是否在编码前压缩文件数据，默认开启
+    void compress(bool enable);
+
+    // 设置文件块格式版本，1为逐块变长序号，2为按页定位的块头部，解码时自动识别
+    bool container(int version);
+
+    // 是否输出三通道彩色页，每个网格单元在青、品红、黄平面各放一个二维码，解码时自动识别
+    void colour(bool enable);
+
+    // 是否增量编码，按输出文件夹中的清单只重新生成内容变化的页，并删除不再需要的旧页
+    void incremental(bool enable);
+
+    // 是否在编码时校验，每页写出后读回图像文件按已知的格点解码并与原始数据比对，结束时输出无法解码的页
+    // 矢量格式无法读回，改为采样生成页面的模块矩阵
+    void verify(bool enable);
+
+    // 开启性能剖析，结束时输出各阶段耗时与计数汇总，并将各线程的计时区间写为Chrome trace-event JSON
+    // counters为true时另按阶段统计硬件计数，输出IPC与缓存、分支未命中率，仅支持Linux
+    bool profile(const fs::path& trace, bool counters = false);
+
+    // 按JSON Lines向file写进度事件，含吞吐、剩余时间与已找到的块数，解码结束时另写找到的块数与缺失的序号区间
+    bool telemetry(const fs::path& file);
+
+    // 解码归档时只恢复指定成员，可多次调用，相对路径或文件名均可
+    void select(const std::string& name);
+
+    // 解码时按水平带识别，每带rows行网格并与下一带重叠一行，用于超大的扫描图像
+    // 图像仍整幅解码为灰度，分带只缩小每次识别的滤波、二值化等工作区与单次耗时，峰值内存仍随图像大小增长；彩色页被拒绝
+    bool band(int rows);
+
+    // 读取由qrb_bench拟合的解码耗时系数文件，自动布局时用于在页数相同的候选中选择
+    bool costs(const fs::path& profile);
+
+    // 读取由tune生成的解码参数文件，解码时使用
+    bool tuning(const fs::path& profile);
+
+    // 以corpus_dir中的图像搜索每秒识别的二维码个数最多且不减少识别个数的解码参数，写到参数文件profile
+    bool tune(const fs::path& corpus_dir, const fs::path& profile);
+
     // 配置解码参数
     bool config(const fs::path& input_dir, const fs::path& output_dir, const fs::path& ecc_dir = {});
 
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cstdint>
+
+namespace qrb::rs {
+    // 各组跨越全部数据交织，编码时需完整的源数据，源数据总字节数上限为64 MiB；解码时逐组读取，不受此限
+    constexpr uint64_t max_total = 64ULL << 20;
+
+    // 配置编码，源数据总字节数、二维码容量、每组数据符号数与校验符号数，总字节数超过max_total时失败
+    bool config(uint64_t total, uint32_t cap, uint32_t k, uint32_t m);
+
+    // 源数据总字节数，0表示未启用
+    uint64_t total();
+
+    // 每个符号的字节数
+    uint32_t symbol();
+
+    // 每组数据符号数
+    uint32_t data();
+
+    // 每组校验符号数
+    uint32_t parity();
+
+    // 分组数，第p个数据符号位于第p % stripes()组
+    uint32_t stripes();
+
+    // 编码一组的全部校验块，依次写入parity()个二维码容量大小的块
+    void encode(uint32_t stripe, std::span<const uint8_t> source, std::span<uint8_t> blocks);
+
+    // 判断块是否为校验块
+    bool check(std::span<const uint8_t> block);
+
+    // 接收一个校验块，首个校验块确定全部参数
+    bool insert(std::span<const uint8_t> block);
+
+    // 由已知数据符号与已接收的校验块恢复一组中缺失的数据符号
+    bool solve(uint32_t stripe, std::vector<std::vector<uint8_t>>& symbols, const std::vector<bool>& known);
+
+    // 清空状态
+    void clean();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cstdint>
+
+namespace qrb::slot {
+    // 每页二维码个数上限，页内位置占7位
+    constexpr uint32_t max_cap = 128;
+
+    // 配置v2编码，按总字节数、二维码容量与每页二维码个数确定块数量，超出头部可表示的范围时返回false
+    bool config(uint64_t total, uint32_t cap, uint32_t per_page);
+
+    // 指定序号的块头部字节数，每页首末两块与尾块为4字节的定位块，其余为2字节的紧凑块；解码时读到尾块前不区分尾块
+    uint32_t len(uint32_t index);
+
+    // 定位块的头部字节数，即头部字节数上限
+    uint32_t len();
+
+    // 每页per_page块时整页各块头部字节数之和，不含尾块
+    uint32_t overhead(uint32_t per_page);
+
+    // 指定序号之前各块头部字节数之和
+    uint64_t sum(uint32_t index);
+
+    // 文件块数量，编码时或解码读到尾块后有效，否则为0
+    uint32_t count();
+
+    // 每页二维码个数，解码时读到定位块前为0
+    uint32_t cap();
+
+    // 是否为v2格式，解码时读到定位块后为true
+    bool active();
+
+    // 解码时读到尾块，记录文件块数量，此后紧凑块可按总页数定位
+    void last(uint32_t index);
+
+    // 写指定序号的块头部
+    void encode(uint32_t index, std::span<uint8_t> data);
+
+    // 判断块是否为定位块
+    bool check(std::span<const uint8_t> block);
+
+    // 解析同一图像的全部块，返回各块序号，0表示非v2块或无法定位
+    // 紧凑块的页号取同一图像中页号低位相同的定位块，没有时在已知总块数且低位只对应一页时确定
+    std::vector<uint32_t> decode(const std::vector<std::vector<uint8_t>>& blocks);
+
+    // 清空状态
+    void clean();
+}
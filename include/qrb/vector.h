@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <filesystem>
+
+#include <opencv2/core.hpp>
+
+namespace fs = std::filesystem;
+
+namespace qrb::vector {
+    // 是否支持该扩展名的矢量图像格式
+    bool support(const std::string& ext);
+
+    // 写一页由黑色矩形组成的矢量图像，单位为像素，原点为左上角；SVG每页单独成文件，PDF则追加到所在文件夹的同名多页文档
+    bool write(const fs::path& file, int width, int height, const std::vector<cv::Rect>& rects);
+
+    // 结束所有多页文档并关闭文件流
+    void close();
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+namespace qrb::zip {
+    // 压缩为zlib格式数据流，单个动态哈夫曼块
+    std::vector<uint8_t> compress(std::span<const uint8_t> data);
+
+    // 流式压缩为zlib格式数据流，read向缓冲区读入原始数据并返回字节数，读尽时返回0；压缩结果分片交给write
+    // 每1 MiB原始数据为一个动态哈夫曼块，匹配可回溯到上一块的最后32 KiB，内存占用与数据大小无关；返回原始字节数
+    uint64_t compress(const std::function<size_t(std::span<uint8_t>)>& read, const std::function<void(std::span<const uint8_t>)>& write);
+
+    // 解压zlib格式数据流，read向缓冲区读入压缩数据并返回字节数，读尽时返回0；解压结果保留最近32 KiB供回溯，更早的部分分片交给write
+    // 输出超过max_size字节时立即停止，数据损坏或校验失败时返回false
+    bool decompress(const std::function<size_t(std::span<uint8_t>)>& read, const std::function<void(std::span<const uint8_t>)>& write, uint64_t max_size);
+
+    // 解压内存中的zlib格式数据流，输出超过max_size字节时失败
+    bool decompress(std::span<const uint8_t> data, std::vector<uint8_t>& output, uint64_t max_size);
+}
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <vector>
 
 #include <qrb/qrb.h>
 
@@ -8,31 +9,76 @@ int wmain(const int argc, const wchar_t* argv[]) {
 int main(const int argc, const char* argv[]) {
 #endif
     bool ok = false;
+    bool valid = true;
     uint32_t mode = 2;
+    bool automatic = false;
+    fs::path trace;        // 性能剖析的输出文件，为空表示不开启
+    bool counters = false; // 性能剖析时统计硬件计数
 
-    if (argc >= 2) {
-        const std::string mode_str = fs::path(argv[1]).string(); // 字符串编码转换
+    std::vector<fs::path> args; // 去除可选项后的位置参数
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = fs::path(argv[i]).string(); // 字符串编码转换
+
+        if (arg == "--format" && i + 1 < argc) valid &= qrb::format(fs::path(argv[++i]).string()); // 不支持的格式视为参数错误
+        else if (arg == "--fountain" && i + 1 < argc) valid &= qrb::rateless(std::stoi(fs::path(argv[++i]).string()));
+        else if (arg == "--rs" && i + 2 < argc) { // 数据符号数与校验符号数
+            const auto k = std::stoi(fs::path(argv[++i]).string());
+            valid &= qrb::erasure(k, std::stoi(fs::path(argv[++i]).string()));
+        }
+        else if (arg == "--store") qrb::compress(false);
+        else if (arg == "--colour") qrb::colour(true);
+        else if (arg == "--incremental") qrb::incremental(true);
+        else if (arg == "--verify") qrb::verify(true);
+        else if (arg == "--profile" && i + 1 < argc) trace = argv[++i];
+        else if (arg == "--counters") counters = true;
+        else if (arg == "--events" && i + 1 < argc) valid &= qrb::telemetry(argv[++i]);
+        else if (arg == "--tuning" && i + 1 < argc) valid &= qrb::tuning(argv[++i]);
+        else if (arg == "--band" && i + 1 < argc) valid &= qrb::band(std::stoi(fs::path(argv[++i]).string()));
+        else if (arg == "--only" && i + 1 < argc) qrb::select(reinterpret_cast<const char*>(fs::path(argv[++i]).u8string().c_str())); // 成员名称按UTF-8匹配
+        else if (arg == "--auto" && i + 3 < argc) { // 纸张尺寸、打印分辨率与每模块的最小像素边长
+            const auto size = fs::path(argv[++i]).string();
+            const auto dpi = std::stoi(fs::path(argv[++i]).string());
+            valid &= qrb::paper(size, dpi, std::stoi(fs::path(argv[++i]).string()));
+            automatic = true;
+        }
+        else if (arg == "--cost" && i + 1 < argc) valid &= qrb::costs(argv[++i]);
+        else if (arg == "--container" && i + 1 < argc) valid &= qrb::container(std::stoi(fs::path(argv[++i]).string()));
+        else args.emplace_back(argv[i]);
+    }
+    if (!trace.empty()) valid &= qrb::profile(trace, counters);
+    else valid &= !counters; // 硬件计数依附于性能剖析
+
+    if (valid && !args.empty()) {
+        const std::string mode_str = args[0].string();
+        const auto num = [&](const size_t i) { return std::stoi(args[i].string()); };
         
-        if (argc == 8 && (mode_str == "--encode" || mode_str == "-e")) {
-            ok = qrb::config(fs::path(argv[2]), fs::path(argv[3]), std::stoi(argv[4]), std::stoi(argv[5]), std::stoi(argv[6]), std::stoi(argv[7]));
+        if (automatic && (args.size() == 3 || args.size() == 4) && (mode_str == "--encode" || mode_str == "-e")) {
+            ok = args.size() == 3 ? qrb::plan(args[1], args[2]) : qrb::plan(args[1], args[2], num(3));
+            mode = 1;
+        } else if (args.size() == 7 && (mode_str == "--encode" || mode_str == "-e")) {
+            ok = qrb::config(args[1], args[2], num(3), num(4), num(5), num(6));
             mode = 1;
-        } else if (argc == 9 && (mode_str == "--encode" || mode_str == "-e")) {
-            ok = qrb::config(fs::path(argv[2]), fs::path(argv[3]), std::stoi(argv[4]), std::stoi(argv[5]), std::stoi(argv[6]), std::stoi(argv[7]), std::stoi(argv[8]));
+        } else if (args.size() == 8 && (mode_str == "--encode" || mode_str == "-e")) {
+            ok = qrb::config(args[1], args[2], num(3), num(4), num(5), num(6), num(7));
             mode = 1;
-        } else if (argc == 4 && (mode_str == "--decode" || mode_str == "-d")) {
-            ok = qrb::config(fs::path(argv[2]), fs::path(argv[3]));
+        } else if (args.size() == 3 && (mode_str == "--decode" || mode_str == "-d")) {
+            ok = qrb::config(args[1], args[2]);
             mode = 0;
-        } else if (argc == 5 && (mode_str == "--decode" || mode_str == "-d")) {
-            ok = qrb::config(fs::path(argv[2]), fs::path(argv[3]), fs::path(argv[4]));
+        } else if (args.size() == 4 && (mode_str == "--decode" || mode_str == "-d")) {
+            ok = qrb::config(args[1], args[2], args[3]);
             mode = 0;
+        } else if (args.size() == 3 && (mode_str == "--tune" || mode_str == "-t")) { // 搜索在此完成，之后无需编解码
+            ok = qrb::tune(args[1], args[2]);
         }
     }
 
     if (!ok) {
         std::cout << "Version: " << qrb::VERSION << std::endl << std::endl;
         std::cout << "Usage:" << std::endl << std::endl
-                  << qrb::NAME << " --encode <input_file> <output_dir> <col> <row> <qr_version> <qr_ecc> [<file_ecc>]" << std::endl
-                  << qrb::NAME << " --decode <input_dir>  <output_dir> [<ecc_dir>]" << std::endl;
+                  << qrb::NAME << " --encode <input_file> <output_dir> <col> <row> <qr_version> <qr_ecc> [<file_ecc>] [--format <ext>] [--fountain <percent>] [--rs <k> <m>] [--store] [--container <version>] [--colour] [--incremental] [--verify] [--events <file>] [--profile <trace.json> [--counters]]" << std::endl
+                  << qrb::NAME << " --encode <input_file> <output_dir> [<file_ecc>] --auto <paper> <dpi> <module_px> [--cost <profile>] [...]" << std::endl
+                  << qrb::NAME << " --decode <input_dir>  <output_dir> [<ecc_dir>] [--only <name>] [--tuning <profile>] [--band <rows>] [--events <file>] [--profile <trace.json> [--counters]]" << std::endl
+                  << qrb::NAME << " --tune   <corpus_dir> <profile> [--tuning <profile>]" << std::endl;
         
         return 1;
     }
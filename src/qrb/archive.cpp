@@ -0,0 +1,230 @@
+#include <array>
+#include <fstream>
+#include <random>
+#include <algorithm>
+
+#include <qrb/zip.h>
+#include <qrb/archive.h>
+
+// 目录格式：4字节标识，变长的后续目录字节数，变长的根名称字节数、根名称，变长的成员数，
+// 每个成员依次为变长的名称字节数、名称、1字节压缩格式、变长的存储字节数与原始字节数；成员数据按目录顺序紧随其后
+namespace {
+    constexpr std::array<uint8_t, 4> magic = {'q', 'r', 'b', 'a'};
+
+    struct source {
+        fs::path path;        // 存储的成员从源文件读取
+        uint64_t length = 0;  // 存储字节数
+        bool spooled = false; // 压缩的成员从临时文件读取
+    };
+
+    std::error_code err;
+    std::vector<uint8_t> directory; // 编码后的目录
+    std::vector<source> members;
+    fs::path spool_path;            // 压缩后的成员数据按目录顺序暂存
+    std::fstream spool;
+    std::ifstream input;            // 当前读取的存储成员
+    std::vector<fs::path> resized;  // 打包后大小改变的存储成员
+    uint64_t dir_pos = 0;           // 已读出的目录字节数
+    size_t current = 0;             // 当前读取的成员
+    uint64_t member_pos = 0;        // 当前成员已读出的字节数
+
+    void put(std::vector<uint8_t>& out, uint64_t value) { // 变长整数，低位在前
+        do {
+            out.push_back(static_cast<uint8_t>((value & 0x7F) | (value > 0x7F ? 0x80 : 0)));
+            value >>= 7;
+        } while (value != 0);
+    }
+
+    bool get(const std::span<const uint8_t> in, size_t& pos, uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+            const auto byte = in[pos++];
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) return true;
+        }
+        return false;
+    }
+
+    bool open_spool() { // 临时文件置于系统临时目录，clean时删除
+        const auto dir = fs::temp_directory_path(err);
+        if (err) return false;
+        std::random_device rd;
+        do spool_path = dir / ("qrb-" + std::to_string(rd()) + ".tmp"); while (fs::exists(spool_path, err));
+        spool = std::fstream(spool_path, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+        return spool.is_open();
+    }
+}
+
+namespace qrb::archive {
+    uint64_t pack(const fs::path& input_dir, const std::u8string& name, const bool compress) {
+        clean();
+        std::vector<fs::path> files;
+        for (const auto& item : fs::recursive_directory_iterator(input_dir, err)) if (item.is_regular_file(err)) files.push_back(item.path());
+        if (err || files.empty() || name.empty()) return 0;
+        std::ranges::sort(files); // 固定顺序，保证同一目录的输出一致
+        if (compress && !open_spool()) return 0;
+
+        std::vector<uint8_t> head;
+        put(head, name.size());
+        head.insert(head.end(), name.begin(), name.end());
+        put(head, files.size());
+        uint64_t body = 0;
+        for (const auto& file : files) {
+            const auto size = fs::file_size(file, err);
+            if (err) { clean(); return 0; }
+
+            bool deflate = false;
+            if (compress) { // 成员分段压缩到临时文件，内存占用与成员大小无关
+                std::ifstream in(file, std::ios::binary);
+                if (!in.is_open()) { clean(); return 0; }
+                const auto start = spool.tellp();
+                const auto original = zip::compress([&](const std::span<uint8_t> buf) {
+                    in.read(reinterpret_cast<char*>(buf.data()), static_cast<int64_t>(buf.size()));
+                    return static_cast<size_t>(in.gcount());
+                }, [&](const std::span<const uint8_t> chunk) { spool.write(reinterpret_cast<const char*>(chunk.data()), static_cast<int64_t>(chunk.size())); });
+                if (!spool.good()) { clean(); return 0; }
+                const auto length = static_cast<uint64_t>(spool.tellp() - start);
+                deflate = original == size && length < size; // 读出的字节数与大小不符时按存储处理，编码时再报告
+                if (!deflate) spool.seekp(start); // 丢弃无收益的压缩结果，由下一个成员覆盖
+                members.push_back({file, deflate ? length : size, deflate});
+            } else members.push_back({file, size, false});
+
+            const auto member = fs::relative(file, input_dir, err).generic_u8string(); // 强制使用UTF-8编码
+            if (err) { clean(); return 0; }
+            put(head, member.size());
+            head.insert(head.end(), member.begin(), member.end());
+            head.push_back(deflate ? 1 : 0);
+            put(head, members.back().length);
+            put(head, size);
+            body += members.back().length;
+        }
+        if (spool.is_open()) spool.seekg(0);
+
+        directory.assign(magic.begin(), magic.end());
+        put(directory, head.size());
+        directory.insert(directory.end(), head.begin(), head.end());
+        return directory.size() + body;
+    }
+
+    size_t read(std::span<uint8_t> data) {
+        const auto n = static_cast<size_t>(std::min<uint64_t>(data.size(), directory.size() - dir_pos));
+        std::copy_n(directory.begin() + static_cast<int64_t>(dir_pos), n, data.begin());
+        dir_pos += n;
+        size_t done = n;
+
+        while (done < data.size() && current < members.size()) {
+            const auto& item = members[current];
+            if (member_pos == 0 && !item.spooled) input = std::ifstream(item.path, std::ios::binary);
+
+            const auto len = static_cast<size_t>(std::min<uint64_t>(data.size() - done, item.length - member_pos));
+            auto& stream = item.spooled ? static_cast<std::istream&>(spool) : input;
+            stream.read(reinterpret_cast<char*>(data.data() + done), static_cast<int64_t>(len));
+            const auto got = static_cast<size_t>(stream.gcount());
+            std::fill(data.begin() + static_cast<int64_t>(done + got), data.begin() + static_cast<int64_t>(done + len), 0); // 源文件在打包后被截短时以零补齐，保持目录记录的偏移
+            stream.clear();
+
+            done += len;
+            member_pos += len;
+            if (!item.spooled && (got < len || (member_pos == item.length && input.peek() != std::ifstream::traits_type::eof()))) { // 截短或增长，恢复的成员与源文件不符
+                if (resized.empty() || resized.back() != item.path) resized.push_back(item.path);
+            }
+            if (member_pos == item.length) {
+                input.close();
+                ++current;
+                member_pos = 0;
+            }
+        }
+        return done;
+    }
+
+    void clean() {
+        std::vector<uint8_t>().swap(directory);
+        std::vector<source>().swap(members);
+        std::vector<fs::path>().swap(resized);
+        input.close();
+        spool.close();
+        if (!spool_path.empty()) fs::remove(spool_path, err);
+        spool_path.clear();
+        dir_pos = 0;
+        current = 0;
+        member_pos = 0;
+    }
+
+    std::vector<fs::path> changed() { return resized; }
+
+    uint64_t size(const std::span<const uint8_t> prefix) {
+        if (prefix.size() < magic.size() || !std::equal(magic.begin(), magic.end(), prefix.begin())) return 0;
+
+        size_t pos = magic.size();
+        uint64_t len = 0;
+        if (!get(prefix, pos, len)) return 0;
+        return pos + len;
+    }
+
+    std::pair<std::string, std::vector<entry>> list(const std::span<const uint8_t> directory) {
+        const auto total = size(directory);
+        if (total == 0 || total > directory.size()) return {};
+
+        size_t pos = magic.size();
+        uint64_t value = 0, count = 0;
+        get(directory, pos, value);
+        if (!get(directory, pos, value) || value > total - pos) return {};
+        std::string root(directory.begin() + static_cast<int64_t>(pos), directory.begin() + static_cast<int64_t>(pos + value));
+        pos += value;
+        if (const auto path = fs::path(std::u8string(root.begin(), root.end())); root.empty() || path != path.filename() || root == "." || root == "..") return {}; // 根名称须为单级名称
+        if (!get(directory, pos, count) || count > directory.size()) return {};
+
+        std::vector<entry> result(count);
+        auto offset = total;
+        for (auto& item : result) {
+            if (!get(directory, pos, value) || value > total - pos) return {};
+            item.name.assign(directory.begin() + static_cast<int64_t>(pos), directory.begin() + static_cast<int64_t>(pos + value));
+            pos += value;
+            if (pos >= total) return {};
+            item.codec = directory[pos++];
+            if (item.codec > 1 || !get(directory, pos, item.length) || !get(directory, pos, item.size)) return {};
+            item.offset = offset;
+            offset += item.length;
+        }
+        if (pos != total) return {};
+        return {root, result};
+    }
+    bool match(const entry& item, const std::string& name) {
+        if (item.name == name) return true;
+        const auto slash = item.name.rfind('/');
+        return slash != std::string::npos && item.name.compare(slash + 1, std::string::npos, name) == 0;
+    }
+
+    bool extract(const entry& item, const std::span<const uint8_t> data, const fs::path& output_dir) {
+        const auto name = fs::path(std::u8string(item.name.begin(), item.name.end()));
+        if (name.empty() || name.has_root_path()) return false;
+        for (const auto& part : name) if (part == "..") return false; // 防止路径穿越
+
+        if (item.codec == 0 && data.size() != item.size) return false;
+
+        const auto file = output_dir / name;
+        fs::create_directories(file.parent_path(), err);
+        std::ofstream output(file, std::ios::binary);
+        if (!output.is_open()) return false;
+
+        bool ok = true;
+        if (item.codec == 1) { // 边解压边写出，超过目录记录的原始字节数时立即停止
+            size_t pos = 0;
+            uint64_t written = 0;
+            ok = zip::decompress([&](const std::span<uint8_t> buf) {
+                const auto n = std::min(buf.size(), data.size() - pos);
+                std::copy_n(data.begin() + static_cast<int64_t>(pos), n, buf.begin());
+                pos += n;
+                return n;
+            }, [&](const std::span<const uint8_t> chunk) {
+                output.write(reinterpret_cast<const char*>(chunk.data()), static_cast<int64_t>(chunk.size()));
+                written += chunk.size();
+            }, item.size) && written == item.size;
+        } else output.write(reinterpret_cast<const char*>(data.data()), static_cast<int64_t>(data.size()));
+        ok = ok && output.flush().good();
+        output.close();
+
+        if (!ok) fs::remove(file, err); // 不保留不完整的成员
+        return ok;
+    }
+}
@@ -0,0 +1,87 @@
+#include <array>
+#include <vector>
+#include <fstream>
+
+#include <qrb/zip.h>
+#include <qrb/bilevel.h>
+
+namespace {
+    constexpr auto crc_table = [] {
+        std::array<uint32_t, 256> table{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        return table;
+    }();
+
+    void put_be32(std::vector<uint8_t>& out, const uint32_t value) {
+        for (int i = 3; i >= 0; --i) out.push_back(static_cast<uint8_t>((value >> (8 * i)) & 0xFF));
+    }
+
+    void chunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data) { // 写PNG数据块
+        put_be32(out, static_cast<uint32_t>(data.size()));
+        const auto beg = out.size();
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), data.begin(), data.end());
+
+        uint32_t crc = 0xFFFFFFFFU;
+        for (auto i = beg; i < out.size(); ++i) crc = crc_table[(crc ^ out[i]) & 0xFF] ^ (crc >> 8);
+        put_be32(out, crc ^ 0xFFFFFFFFU);
+    }
+}
+
+namespace qrb::bilevel {
+    bool support(const std::string& ext) { return ext == ".png" || ext == ".pbm"; }
+
+    bool write(const fs::path& file, const int width, const int height, const row_fn& fill) {
+        const auto ext = file.extension().string();
+        if (!support(ext) || width <= 0 || height <= 0) return false;
+
+        const auto stride = static_cast<size_t>(width + 7) / 8;
+        std::vector<uint8_t> row(stride, 0), prev(stride, 0), binary;
+
+        if (ext == ".pbm") {
+            const auto header = "P4\n" + std::to_string(width) + " " + std::to_string(height) + "\n";
+            binary.reserve(header.size() + stride * height);
+            binary.insert(binary.end(), header.begin(), header.end());
+            for (int y = 0; y < height; ++y) {
+                fill(y, row);
+                binary.insert(binary.end(), row.begin(), row.end());
+            }
+        } else {
+            std::vector<uint8_t> raw; // 每行前置滤波类型
+            raw.reserve((stride + 1) * height);
+            for (int y = 0; y < height; ++y) {
+                fill(y, row);
+                if (y > 0 && row == prev) { // 与上一行相同时使用Up滤波，整行为零
+                    raw.push_back(2);
+                    raw.insert(raw.end(), stride, 0);
+                } else {
+                    raw.push_back(0);
+                    raw.insert(raw.end(), row.begin(), row.end());
+                    prev = row;
+                }
+            }
+
+            std::vector<uint8_t> ihdr;
+            put_be32(ihdr, width);
+            put_be32(ihdr, height);
+            ihdr.insert(ihdr.end(), {1, 3, 0, 0, 0}); // 1位调色板，无隔行
+
+            binary = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+            chunk(binary, "IHDR", ihdr);
+            chunk(binary, "PLTE", {0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00}); // 0为白色，1为黑色
+            chunk(binary, "IDAT", qrb::zip::compress(raw));
+            chunk(binary, "IEND", {});
+        }
+
+        std::ofstream output(file, std::ios::binary);
+        if (!output.is_open()) return false;
+        output.write(reinterpret_cast<const char*>(binary.data()), static_cast<int64_t>(binary.size()));
+        output.close();
+
+        return true;
+    }
+}
@@ -1,14 +1,28 @@
+#include <cstdio>
 #include <iostream>
 #include <fstream>
-#include <format>
 #include <valarray>
 #include <ranges>
+#include <algorithm>
+#include <map>
+#include <random>
+
+#ifdef WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
 
 #include <opencv2/imgcodecs.hpp>
 
 #include <qrb/qr.h>
 #include <qrb/index.h>
 #include <qrb/page.h>
+#include <qrb/rs.h>
+#include <qrb/zip.h>
+#include <qrb/slot.h>
+#include <qrb/archive.h>
+#include <qrb/probe.h>
+#include <qrb/progress.h>
 #include <qrb/file.h>
 
 namespace {
@@ -21,37 +35,220 @@ namespace {
     uint64_t cnt_r = 0; // 余量计数器
 
     std::vector<uint8_t> file_attr; // 编码后的元数据
+    fs::path spool_path;            // 压缩后的文件数据暂存的临时文件，为空表示存储模式
+    std::fstream spool;
+    bool archived = false;          // 归档模式，数据由archive按顺序读出
     uint64_t file_size = 0;
 
-    int64_t seek(const uint32_t index, const bool is_ecc) { return (index - (is_ecc ? 0 : 1)) * qrb::qr::cap() - qrb::index::sum(index, is_ecc); }
+    constexpr size_t window_size = 1 << 20; // 流式读取的预读缓冲容量，远大于单块容量
+    bool piped = false;                     // 从标准输入流式读取，文件大小随读取增长，读完才确定
+    bool piped_eof = false;
+    std::vector<uint8_t> window;            // 预读缓冲，[win_beg, win_end)为未编码的数据
+    size_t win_beg = 0;
+    size_t win_end = 0;
+
+    std::string delta_key;                             // 增量编码时的页面渲染参数，为空表示不使用增量编码
+    std::array<std::map<std::string, uint64_t>, 2> manifest; // [0] -> 上次编码 [1] -> 本次编码，页路径 => 散列值
+    constexpr auto manifest_name = "manifest";
+
+    bool verify_pages = false;          // 写页后在内存中按格点解码校验
+    uint64_t checked = 0;               // 已校验的页数
+    std::vector<fs::path> unreadable;   // 未通过校验的页，相对输出文件夹
+
+    // 元数据首字节为0时，其后一字节为压缩格式，文件名非空故与旧格式不冲突；存储模式保持旧格式
+    constexpr uint8_t codec_store = 0;
+    constexpr uint8_t codec_deflate = 1; // 压缩格式后为8字节的原始字节数，解压时作为输出上限
+    constexpr uint8_t codec_archive = 2; // 多文件归档，文件名为目录名，成员各自压缩
+
+    void fill() { // 预读不足一块时补满缓冲，未读完时剩余量至少为一块，尾块由此判断
+        if (!piped || piped_eof || win_end - win_beg >= static_cast<size_t>(qrb::qr::cap())) return;
+
+        std::copy(window.begin() + static_cast<int64_t>(win_beg), window.begin() + static_cast<int64_t>(win_end), window.begin());
+        win_end -= win_beg;
+        win_beg = 0;
+
+        while (win_end < window.size()) {
+            const auto n = std::fread(window.data() + win_end, 1, window.size() - win_end, stdin);
+            if (n == 0) {piped_eof = true; break;}
+            win_end += n;
+            file_size += n;
+            cnt_t += n;
+            cnt_r += n;
+        }
+    }
+
+    bool open_spool() { // 临时文件置于系统临时目录，clean时删除
+        const auto dir = fs::temp_directory_path(err);
+        if (err) return false;
+        std::random_device rd;
+        do spool_path = dir / ("qrb-" + std::to_string(rd()) + ".tmp"); while (fs::exists(spool_path, err));
+        spool = std::fstream(spool_path, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+        if (!spool.is_open()) spool_path.clear(); // 无法创建时使用存储模式
+        return spool.is_open();
+    }
+
+    void close_spool() {
+        spool.close();
+        if (!spool_path.empty()) fs::remove(spool_path, err);
+        spool_path.clear();
+    }
+
+    uint64_t digest(const std::span<const uint8_t> data) { // 渲染参数与页原始数据的FNV-1a散列
+        uint64_t h = 0xCBF29CE484222325ULL;
+        for (const auto c : delta_key) h = (h ^ static_cast<uint8_t>(c)) * 0x100000001B3ULL;
+        for (const auto b : data) h = (h ^ b) * 0x100000001B3ULL;
+        return h;
+    }
+
+    int64_t seek(const uint32_t index, const bool is_ecc) {
+        if (!is_ecc && qrb::slot::active()) return static_cast<int64_t>((index - 1) * static_cast<uint64_t>(qrb::qr::cap()) - qrb::slot::sum(index)); // v2各块头部长度由页内位置确定
+        return (index - (is_ecc ? 0 : 1)) * qrb::qr::cap() - qrb::index::sum(index, is_ecc);
+    }
+
+    void repair_rs(std::array<std::unordered_map<uint32_t, bool>, 2>& index, std::optional<uint32_t>& last_index) { // 跨页纠删码按组修复
+        const auto total = qrb::rs::total();
+        const uint64_t c_len = qrb::rs::symbol();
+        const auto k = qrb::rs::data(), s_cnt = qrb::rs::stripes();
+        const auto q = (total + c_len - 1) / c_len; // 符号总数
+
+        // 由总字节数推算各文件块在数据流中的边界，与编码时的分块一致，第i块为[bound[i - 1], bound[i])
+        std::vector<uint64_t> bound = {0};
+        for (uint32_t i = 1; ; ++i) {
+            const uint64_t len = qrb::qr::cap() - (qrb::slot::active() ? qrb::slot::len(i) : qrb::index::len(i));
+            if (qrb::slot::active() ? total - bound.back() < qrb::qr::cap() - qrb::slot::len() : qrb::index::len(0) + total - bound.back() <= len) { bound.push_back(total); break; } // v2尾块为定位块
+            bound.push_back(bound.back() + len);
+        }
+        const auto n = static_cast<uint32_t>(bound.size() - 1);
+
+        // 符号重叠的文件块均已接收时，该符号已知
+        std::vector<bool> known(q);
+        for (uint64_t t = 0; t < q; ++t) {
+            const auto first = std::ranges::upper_bound(bound, t * c_len) - bound.begin();
+            const auto last = std::ranges::lower_bound(bound, std::min(total, (t + 1) * c_len)) - bound.begin();
+            bool ok = true;
+            for (auto i = first; i <= last && ok; ++i) ok = index[0].contains(static_cast<uint32_t>(i));
+            known[t] = ok;
+        }
+
+        std::vector<std::vector<uint8_t>> symbols(k, std::vector<uint8_t>(c_len));
+        std::vector<bool> have(k);
+        qrb::progress::start("Repair", s_cnt, "stripes");
+        for (uint32_t s = 0; s < s_cnt; ++s) {
+            qrb::progress::set(s);
+
+            bool lost = false;
+            for (uint32_t p = 0; p < k; ++p) {
+                const auto t = static_cast<uint64_t>(p) * s_cnt + s;
+                have[p] = t >= q || known[t];
+                lost |= !have[p];
+            }
+            if (!lost) continue;
+
+            for (uint32_t p = 0; p < k; ++p) { // 读取已知符号，末符号不足部分及超出总数的符号为零
+                const auto t = static_cast<uint64_t>(p) * s_cnt + s;
+                std::ranges::fill(symbols[p], 0);
+                if (t >= q || !have[p]) continue;
+                stream[0].clear();
+                stream[0].seekg(static_cast<int64_t>(t * c_len)).read(reinterpret_cast<char*>(symbols[p].data()), static_cast<int64_t>(std::min(c_len, total - t * c_len)));
+            }
+
+            if (!qrb::rs::solve(s, symbols, have)) continue; // 该组缺失数超过可用校验数
+
+            for (uint32_t p = 0; p < k; ++p) {
+                const auto t = static_cast<uint64_t>(p) * s_cnt + s;
+                if (have[p]) continue;
+                stream[0].clear();
+                stream[0].seekp(static_cast<int64_t>(t * c_len)).write(reinterpret_cast<const char*>(symbols[p].data()), static_cast<int64_t>(std::min(c_len, total - t * c_len)));
+                known[t] = true;
+            }
+        }
+
+        for (uint32_t i = 1; i <= n; ++i) { // 重叠符号均已知的文件块视为已恢复
+            if (index[0].contains(i)) continue;
+            bool ok = true;
+            for (auto t = bound[i - 1] / c_len; t * c_len < bound[i] && ok; ++t) ok = known[t];
+            if (ok) index[0][i] = true;
+        }
+        if (index[0].contains(n)) last_index = n;
+
+        qrb::progress::finish();
+    }
 }
 
 namespace qrb::file {
-    bool config(const fs::path& input_file, const fs::path& output_dir) {
-        const auto timestamp = static_cast<uint32_t>(std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count());
-        const auto file_name = input_file.filename().u8string(); // 强制使用UTF-8编码，否则MSVC与GCC编译产物可能无法互相解码各自导出的内容
-        if (file_name.size() > 255) return false;
+    bool config(const fs::path& input_file, const fs::path& output_dir, const bool compress) {
+        auto timestamp = static_cast<uint32_t>(std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+        const auto base = input_file.has_filename() ? input_file : input_file.parent_path(); // 目录路径可能以分隔符结尾
+        piped = input_file == "-";
+        if (auto t = fs::last_write_time(input_file, err); !delta_key.empty() && !piped && !err) { // 增量编码时取输入的修改时间，内容不变则元数据所在页也不变
+            if (fs::is_directory(input_file, err)) for (const auto& item : fs::recursive_directory_iterator(input_file, err)) t = std::max(t, item.last_write_time(err)); // 目录取其中最新的修改时间，增删成员时所在目录的修改时间也会变化
+            timestamp = static_cast<uint32_t>(std::chrono::floor<std::chrono::seconds>(std::chrono::file_clock::to_sys(t)).time_since_epoch().count());
+        }
+        const auto file_name = piped ? u8"stdin" : base.filename().u8string(); // 强制使用UTF-8编码，否则MSVC与GCC编译产物可能无法互相解码各自导出的内容
+        if (file_name.empty() || file_name.size() > 255) return false;
 
         file_attr.resize(0);
         file_attr.push_back(static_cast<uint8_t>(file_name.size() & 0xFF)); // 文件名长度
         for (int i = 3; i >= 0; --i) file_attr.push_back(static_cast<uint8_t>((timestamp >> (8 * i)) & 0xFF)); // UTC 秒级时间戳
         file_attr.insert(file_attr.end(), file_name.begin(), file_name.end()); // 文件名
 
-        file_size = fs::file_size(input_file, err);
+        close_spool();
+        if (piped) { // 流式读取不预知大小，无法整体压缩，使用存储模式
+#ifdef WIN32
+            _setmode(_fileno(stdin), _O_BINARY); // 标准输入默认为文本模式
+#endif
+            window.resize(window_size);
+            win_beg = win_end = 0;
+            piped_eof = false;
+            file_size = 0;
+        } else if (fs::is_directory(input_file, err)) { // 归档模式，仅目录置于内存，成员数据在编码时流式读出
+            file_size = archive::pack(input_file, file_name, compress);
+            if (file_size == 0) return false;
+            archived = true;
+            file_attr.insert(file_attr.begin(), {0, codec_archive});
+        } else {
+            file_size = fs::file_size(input_file, err);
+            if (err || file_size == 0) return false;
+
+            stream[0] = std::fstream(input_file, std::ios::binary | std::ios::in);
+            if (!stream[0].is_open()) return false;
+
+            if (compress && open_spool()) { // 分块需预先得到总字节数，故先流式压缩到临时文件，内存占用与文件大小无关
+                const auto original = zip::compress([&](const std::span<uint8_t> buf) {
+                    stream[0].read(reinterpret_cast<char*>(buf.data()), static_cast<int64_t>(buf.size()));
+                    return static_cast<size_t>(stream[0].gcount());
+                }, [&](const std::span<const uint8_t> chunk) { spool.write(reinterpret_cast<const char*>(chunk.data()), static_cast<int64_t>(chunk.size())); });
+                const auto packed_size = static_cast<uint64_t>(spool.tellp());
+                stream[0].clear();
+                stream[0].seekg(0);
+
+                std::array<uint8_t, 10> head = {0, codec_deflate};
+                for (int i = 0; i < 8; ++i) head[2 + i] = static_cast<uint8_t>((original >> (8 * (7 - i))) & 0xFF);
+                if (!spool.good() || original != file_size || packed_size + head.size() >= file_size) close_spool(); // 压缩无收益或读写出错时回退为存储模式
+                else {
+                    file_size = packed_size;
+                    file_attr.insert(file_attr.begin(), head.begin(), head.end());
+                    spool.seekg(0);
+                }
+            }
+        }
+
         cnt_r = cnt_t = file_size + file_attr.size();
+        fill();
 
-        const auto max_file_size = index::max() * qr::cap() -
-                                   index::sum(index::max(), false) -
-                                   index::len(0) -
-                                   index::len(index::max()) -
-                                   file_attr.size();
-        if (err || file_size == 0 || file_size > max_file_size) return false;
+        if (!fits()) return false;
 
         list = {output_dir / "file", output_dir / "ecc"};
         for (const auto& dir : list) if (fs::create_directories(dir, err); err) return false;
-        stream[0] = std::fstream(input_file, std::ios::binary | std::ios::in);
 
-        return stream[0].is_open();
+        for (auto& m : manifest) m.clear();
+        if (!delta_key.empty()) { // 读取上次编码的清单，不存在时全部生成
+            std::ifstream input(output_dir / manifest_name);
+            uint64_t h = 0;
+            for (std::string page; input >> std::hex >> h >> page;) manifest[0][page] = h;
+        }
+
+        return true;
     }
 
     bool config(const fs::path& input_dir, const fs::path& output_dir, const fs::path& ecc_dir) {
@@ -79,24 +276,65 @@ namespace qrb::file {
     }
 
     void clean() {
+        if (!delta_key.empty() && !list.empty()) { // 删除本次不再生成的旧页，并保存新的清单
+            for (const auto& page : manifest[0] | std::views::keys) {
+                if (manifest[1].contains(page)) continue;
+                if (const auto dir = page.substr(0, page.find('/')); dir == "file" || dir == "ecc") fs::remove(list[dir == "ecc"] / fs::path(page).filename(), err);
+            }
+
+            std::ofstream output(list[0].parent_path() / manifest_name);
+            for (const auto& [page, h] : manifest[1]) output << std::hex << h << " " << page << "\n";
+        }
+        for (auto& m : manifest) m.clear();
+        delta_key.clear();
+        verify_pages = false;
+        checked = 0;
+        unreadable.clear();
+
         for (auto& s : stream) s.close();
         std::vector<fs::path>().swap(list);
         std::vector<uint8_t>().swap(file_attr);
+        close_spool();
+        std::vector<uint8_t>().swap(window);
+        archive::clean();
+        archived = false;
+        piped = false;
         bnd = 0;
         cnt_t = 0;
         cnt_r = 0;
     }
 
+    bool fits() {
+        const auto max_file_size = static_cast<uint64_t>(index::max()) * qr::cap() -
+                                   index::sum(index::max(), false) -
+                                   index::len(0) -
+                                   index::len(index::max()) -
+                                   file_attr.size();
+        return file_size <= max_file_size;
+    }
+
     uint64_t total() { return cnt_t; }
-    uint64_t remain() { return cnt_r; }
+
+    uint64_t remain() {
+        fill();
+        return cnt_r;
+    }
+
+    bool streaming() { return piped; }
 
     uint64_t read(std::span<uint8_t> data, uint64_t offset, const uint64_t length) {
-        const auto bin_len = std::min(length, file_size - stream[0].tellg()); // 文件流字节长
-        const auto m_len = std::min(length - bin_len, file_attr.size());      // 元数据字节长
+        fill();
+        const auto pos = std::min(cnt_t - cnt_r, file_size);             // 已读文件数据字节数，文件数据在元数据之前
+        const auto bin_len = std::min(length, file_size - pos);           // 文件流字节长
+        const auto m_len = std::min(length - bin_len, file_attr.size()); // 元数据字节长
 
         cnt_r -= bin_len + m_len;
 
-        stream[0].read(reinterpret_cast<char*>(&data[0]) + offset, static_cast<int64_t>(bin_len));
+        if (piped) {
+            std::copy_n(window.begin() + static_cast<int64_t>(win_beg), bin_len, data.begin() + static_cast<int64_t>(offset));
+            win_beg += bin_len;
+        } else if (archived) archive::read(std::span{data}.subspan(offset, bin_len));
+        else (spool_path.empty() ? static_cast<std::istream&>(stream[0]) : spool).read(reinterpret_cast<char*>(&data[0]) + offset, static_cast<int64_t>(bin_len));
         offset += bin_len;
 
         std::reverse_copy(file_attr.end() - static_cast<int64_t>(m_len), file_attr.end(), begin(data) + static_cast<int64_t>(offset));
@@ -105,35 +343,121 @@ namespace qrb::file {
         return bin_len + m_len;
     }
 
+    void incremental(const std::string& key) { delta_key = key; }
+
+    void verify(const bool enable) { verify_pages = enable; }
+
+    std::pair<uint64_t, std::vector<fs::path>> verified() { return {checked, unreadable}; }
+
     void write(std::span<const uint8_t> data, const fs::path& file_name, const bool is_ecc) {
+        if (!delta_key.empty()) { // 内容与渲染参数均未变且旧页仍在时跳过渲染
+            const auto page = (is_ecc ? "ecc/" : "file/") + file_name.string();
+            const auto h = manifest[1][page] = digest(data);
+            if (const auto it = manifest[0].find(page); it != manifest[0].end() && it->second == h && fs::exists(list[is_ecc] / file_name, err)) return;
+        }
         page::write(data, list[is_ecc] / file_name);
+        if (!verify_pages) return;
+        ++checked;
+        if (!page::check(data, list[is_ecc] / file_name)) unreadable.push_back(fs::path(is_ecc ? "ecc" : "file") / file_name);
     }
 
     std::pair<std::vector<std::vector<uint8_t>>, bool> read() {
         if (cnt_r == 0) return {};
         const auto index = cnt_t - (cnt_r--);
-        return {page::read(list[index]), index >= bnd};
+        return {page::read(list[index], slot::cap()), index >= bnd}; // v2格式已知每页二维码个数时可提前结束识别
     }
 
     void write(std::span<const uint8_t> data, const uint64_t offset, const uint32_t index, const bool is_ecc) {
+        probe::zone zone("file::write");
+        probe::count("bytes_written", static_cast<int64_t>(data.size() - offset));
         stream[is_ecc].seekp(seek(index, is_ecc)).write(reinterpret_cast<const char*>(data.data()) + offset, static_cast<int64_t>(data.size() - offset));
     }
 
+    void restore(const std::span<const uint8_t> data) {
+        probe::zone zone("file::write");
+        probe::count("bytes_written", static_cast<int64_t>(data.size()));
+        stream[0].seekp(0).write(reinterpret_cast<const char*>(data.data()), static_cast<int64_t>(data.size()));
+    }
+
     std::tuple<uint64_t, uint32_t, fs::path> metadata() {
         file_size = stream[0].seekg(0, std::ios::end).tellg();
-        file_attr = std::vector<uint8_t>(std::min(static_cast<uint64_t>(260), file_size));
+        file_attr = std::vector<uint8_t>(std::min(static_cast<uint64_t>(270), file_size)); // 压缩格式2字节，原始字节数8字节，文件名长度与时间戳5字节，文件名至多255字节
         if (file_attr.size() < 5) return {};
 
         const auto offset = static_cast<int64_t>(file_attr.size());
         stream[0].seekg(-offset, std::ios::end).read(reinterpret_cast<char *>(file_attr.data()), offset);
         std::ranges::reverse(file_attr);
 
+        uint8_t codec = codec_store;
+        uint64_t original = 0;
+        if (file_attr[0] == 0) { // 带压缩格式的元数据
+            codec = file_attr[1];
+            file_attr.erase(file_attr.begin(), file_attr.begin() + 2);
+            file_size -= 2;
+            if (codec == codec_deflate) {
+                if (file_attr.size() < 8) return {};
+                for (int i = 0; i < 8; ++i) original = (original << 8) | file_attr[i];
+                file_attr.erase(file_attr.begin(), file_attr.begin() + 8);
+                file_size -= 8;
+            }
+            if (file_attr.size() < 5 || codec > codec_archive) return {};
+        }
+
         const uint32_t timestamp = (file_attr[1] << 24) | (file_attr[2] << 16) | (file_attr[3] << 8) | file_attr[4];
         if (file_attr.size() < 5 + file_attr[0]) return {};
         const auto file_name = fs::path(std::u8string(file_attr.begin() + 5, file_attr.begin() + 5 + file_attr[0])).filename(); // 防止路径穿越
         file_size -= 5 + file_attr[0];
 
+        if (codec == codec_archive) { // 逐个成员读入并解包到以归档根名称命名的目录
+            const auto len = archive::size(load(0, 14));
+            if (len == 0 || len > file_size) return {};
+            const auto [root, items] = archive::list(load(0, len));
+            if (items.empty()) return {};
+
+            uint64_t total_size = 0;
+            for (const auto& item : items) {
+                if (item.offset + item.length > file_size) return {};
+                if (!archive::extract(item, load(item.offset, item.length), list.back() / fs::path(std::u8string(root.begin(), root.end())))) return {};
+                total_size += item.size;
+            }
+
+            discard();
+            return {total_size, timestamp, file_name};
+        }
+
         for (auto& s : stream) s.close();
+
+        if (codec == codec_deflate) { // 边解压边写出，输出超过原始字节数时立即停止；压缩数据损坏时删除不完整的输出并保留file.bin
+            const auto part = list.back() / "file.part"; // 先写到临时名称，文件名为file.bin或ecc.bin时也不会覆盖或删除解压结果
+            std::ifstream input(list.back() / "file.bin", std::ios::binary);
+            std::ofstream output(part, std::ios::binary);
+            if (!input.is_open() || !output.is_open()) return {};
+
+            uint64_t remain = file_size, written = 0; // file.bin末尾为元数据，不属于压缩数据
+            const bool ok = zip::decompress([&](const std::span<uint8_t> buf) {
+                const auto n = static_cast<size_t>(std::min<uint64_t>(buf.size(), remain));
+                input.read(reinterpret_cast<char*>(buf.data()), static_cast<int64_t>(n));
+                remain -= static_cast<uint64_t>(input.gcount());
+                return static_cast<size_t>(input.gcount());
+            }, [&](const std::span<const uint8_t> chunk) {
+                output.write(reinterpret_cast<const char*>(chunk.data()), static_cast<int64_t>(chunk.size()));
+                written += chunk.size();
+            }, original) && written == original && output.flush().good();
+            output.close();
+            input.close();
+
+            if (!ok) {
+                fs::remove(part, err);
+                return {};
+            }
+
+            fs::remove(list.back() / "file.bin", err);
+            fs::remove(list.back() / "ecc.bin", err);
+            fs::rename(part, list.back() / file_name, err);
+
+            return {original, timestamp, file_name};
+        }
+
         fs::resize_file(list.back() / "file.bin", file_size, err);
         fs::remove(list.back() / "ecc.bin", err);
         fs::rename(list.back() / "file.bin", list.back() / file_name, err);
@@ -141,14 +465,54 @@ namespace qrb::file {
         return {file_size, timestamp, file_name};
     }
 
-    void repair(std::array<std::unordered_map<uint32_t, bool>, 2>& index, const bool has_last) {
+    uint64_t find(const uint32_t number) {
+        const auto name = std::to_string(number);
+        for (uint64_t i = 0; i < bnd; ++i) if (list[i].stem() == name) return i;
+        return cnt_t;
+    }
+
+    std::pair<std::vector<std::vector<uint8_t>>, bool> read(const uint64_t i) {
+        if (i >= cnt_t) return {};
+        return {page::read(list[i], slot::cap()), i >= bnd};
+    }
+
+    uint64_t offset(const uint32_t index) { return seek(index, false); }
+
+    uint32_t locate(const uint64_t pos) {
+        uint32_t lo = 1, hi = static_cast<uint32_t>(pos / (qr::cap() - std::max(index::len(index::max()), slot::len())) + 1); // 非尾块至少容纳的字节数给出上界
+        while (lo < hi) { // 最后一个偏移不超过pos的块
+            const auto mid = lo + (hi - lo + 1) / 2;
+            if (static_cast<uint64_t>(seek(mid, false)) <= pos) lo = mid; else hi = mid - 1;
+        }
+        return lo;
+    }
+
+    std::vector<uint8_t> load(const uint64_t offset, const uint64_t length) {
+        std::vector<uint8_t> data(length);
+        stream[0].clear();
+        stream[0].seekg(static_cast<int64_t>(offset)).read(reinterpret_cast<char*>(data.data()), static_cast<int64_t>(length));
+        data.resize(stream[0].gcount());
+        return data;
+    }
+
+    void discard() {
+        for (auto& s : stream) s.close();
+        fs::remove(list.back() / "file.bin", err);
+        fs::remove(list.back() / "ecc.bin", err);
+    }
+
+    void repair(std::array<std::unordered_map<uint32_t, bool>, 2>& index, std::optional<uint32_t>& last_index) {
+        probe::zone zone("file::repair");
+        if (rs::total() != 0) { repair_rs(index, last_index); return; }
+
+        const bool has_last = last_index.has_value();
         if (index::step() == 1 || index[1].empty()) return;
         std::array buffer{std::valarray<uint8_t>(qr::cap()), std::valarray<uint8_t>(qr::cap())};
 
-        for (uint32_t i = 0, m = std::ranges::max(index[0] | std::views::keys); i <= m; i += index::step()) { // 按组处理
-            std::cout << "\r"
-                      << std::format(" {:>4.1f}% [Repair]                ", 99.9 * static_cast<double>(i) / static_cast<double>(m))
-                      << std::flush;
+        const auto m = std::ranges::max(index[0] | std::views::keys);
+        progress::start("Repair", m, "blocks");
+        for (uint32_t i = 0; i <= m; i += index::step()) { // 按组处理
+            progress::set(i);
 
             if (!index[1].contains(index::convert(i))) continue; // 该组的奇偶校验块不存在
 
@@ -175,6 +539,6 @@ namespace qrb::file {
             }
         }
 
-        std::cout << "\r" << "100.0% [Repair]" << std::flush;
+        progress::finish();
     }
 }
\ No newline at end of file
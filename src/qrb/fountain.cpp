@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <bit>
+#include <unordered_set>
+
+#include <qrb/fountain.h>
+
+namespace {
+    constexpr uint32_t seed_len = 3; // 种子固定3字节，大端序
+    constexpr uint32_t max_seed = (1U << (8 * seed_len)) - 1;
+    constexpr uint64_t weight_scale = 1ULL << 30; // 度分布权重的定点缩放
+    constexpr size_t degree_shift = 4;            // 修复符号的度整体偏移，系统符号已提供剥离所需的低度方程，偏移后显著降低秩不足的概率
+
+    uint64_t src_len = 0;  // 源数据总字节数
+    uint32_t blk_len = 0;  // 每个源块字节数
+    uint32_t blk_cnt = 0;  // 源块数量
+    uint32_t head_len = 0; // 符号头部字节数
+
+    std::vector<uint64_t> cdf; // 鲁棒孤波分布的累积权重，全程整数运算，保证各平台编码一致
+
+    std::vector<uint32_t> seeds;
+    std::vector<std::vector<uint8_t>> symbols;
+    std::unordered_set<uint32_t> seen;
+
+    uint32_t varint_len(uint64_t value) {
+        uint32_t count = 0;
+        do { value >>= 7; ++count; } while (value > 0);
+        return count;
+    }
+
+    uint64_t next(uint64_t& state) { // splitmix64
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t ln(const uint64_t value) { return std::max<uint64_t>(1, std::bit_width(value) * 710 / 1024); } // 自然对数的整数近似
+
+    uint64_t isqrt(const uint64_t value) {
+        uint64_t r = 0;
+        while ((r + 1) * (r + 1) <= value) ++r;
+        return r;
+    }
+
+    void setup(const uint64_t total, const uint32_t length) { // 由源数据总字节数与源块字节数计算编解码参数
+        src_len = total;
+        blk_len = length;
+        blk_cnt = static_cast<uint32_t>((total + length - 1) / length);
+        head_len = 2 + seed_len + varint_len(total);
+
+        // 鲁棒孤波分布，c = 0.1，delta约为0.05，对数项加3即ln(1/delta)
+        const uint64_t k = blk_cnt;
+        const uint64_t r = std::max<uint64_t>(1, isqrt(k) * (ln(k) + 3) / 10);
+        const uint64_t spike = std::clamp<uint64_t>(k / r, 1, k);
+
+        cdf.assign(k, 0);
+        uint64_t sum = 0;
+        for (uint64_t d = 1; d <= k; ++d) {
+            sum += d == 1 ? weight_scale / k : weight_scale / (d * (d - 1));
+            if (d < spike) sum += weight_scale * r / (d * k);
+            else if (d == spike) sum += weight_scale * r * (ln(r) + 3) / k;
+            cdf[d - 1] = sum;
+        }
+    }
+
+    void neighbors(const uint32_t seed, std::vector<uint32_t>& result) { // 符号对应的源块序号，升序且不重复
+        result.clear();
+        if (seed < blk_cnt) { result.push_back(seed); return; }
+
+        uint64_t state = seed * 0x2545F4914F6CDD1DULL ^ blk_cnt;
+        const auto pick = next(state) % cdf.back();
+        const auto base = static_cast<size_t>(std::ranges::upper_bound(cdf, pick) - cdf.begin()) + 1;
+        const auto degree = std::clamp<size_t>(base + degree_shift, 1, std::max<size_t>(1, (blk_cnt + 1) / 2)); // 源块很少时不超过半数，避免组合雷同
+
+        while (result.size() < degree) {
+            while (result.size() < degree) result.push_back(static_cast<uint32_t>(next(state) % blk_cnt));
+            std::ranges::sort(result);
+            result.erase(std::ranges::unique(result).begin(), result.end());
+        }
+    }
+
+    void xor_into(std::span<uint8_t> dst, const std::span<const uint8_t> src) {
+        for (size_t i = 0; i < src.size(); ++i) dst[i] ^= src[i];
+    }
+
+    void xor_into(std::vector<uint64_t>& dst, const std::vector<uint64_t>& src) {
+        if (dst.size() < src.size()) dst.resize(src.size(), 0);
+        for (size_t i = 0; i < src.size(); ++i) dst[i] ^= src[i];
+    }
+}
+
+namespace qrb::fountain {
+    uint32_t config(const uint64_t total, const uint32_t cap) {
+        clean();
+
+        const auto head = 2 + seed_len + varint_len(total);
+        if (total == 0 || total > max_total || cap <= head) return 0;
+        setup(total, cap - head);
+
+        return blk_cnt;
+    }
+
+    uint32_t count() { return blk_cnt; }
+
+    uint32_t max() { return max_seed; }
+
+    void encode(const uint32_t seed, const std::span<const uint8_t> source, const std::span<uint8_t> symbol) {
+        // 头部：两个零字节，与文件块序号编码不冲突；种子；源数据总字节数
+        symbol[0] = 0;
+        symbol[1] = 0;
+        for (uint32_t i = 0; i < seed_len; ++i) symbol[2 + i] = static_cast<uint8_t>((seed >> (8 * (seed_len - 1 - i))) & 0xFF);
+        auto value = src_len;
+        for (uint32_t i = 2 + seed_len; i < head_len; ++i, value >>= 7) symbol[i] = static_cast<uint8_t>((value & 0x7F) | (i + 1 < head_len ? 0x80 : 0));
+
+        const auto payload = symbol.subspan(head_len, blk_len);
+        std::ranges::fill(payload, 0);
+
+        std::vector<uint32_t> nb;
+        neighbors(seed, nb);
+        for (const auto b : nb) { // 末块不足部分视为零
+            const auto beg = static_cast<size_t>(b) * blk_len;
+            if (beg < source.size()) xor_into(payload, source.subspan(beg, std::min<size_t>(blk_len, source.size() - beg)));
+        }
+    }
+
+    bool check(const std::span<const uint8_t> block) { return block.size() > 2 + seed_len && block[0] == 0 && block[1] == 0; }
+
+    bool insert(const std::span<const uint8_t> block) {
+        if (!check(block)) return false;
+
+        uint32_t seed = 0;
+        for (uint32_t i = 0; i < seed_len; ++i) seed = (seed << 8) | block[2 + i];
+
+        uint64_t total = 0;
+        uint32_t pos = 2 + seed_len, shift = 0;
+        for (; pos < block.size() && shift < 63; ++pos, shift += 7) {
+            total |= static_cast<uint64_t>(block[pos] & 0x7F) << shift;
+            if ((block[pos] & 0x80) == 0) break;
+        }
+        if (pos >= block.size() || total == 0 || total > max_total || varint_len(total) != pos - 1 - seed_len) return false;
+        ++pos;
+
+        if (blk_cnt == 0) setup(total, static_cast<uint32_t>(block.size() - pos)); // 首个符号确定全部参数
+        if (total != src_len || block.size() != head_len + blk_len) return false;
+        if (!seen.insert(seed).second) return false;
+
+        seeds.push_back(seed);
+        symbols.emplace_back(block.begin() + head_len, block.end());
+        return true;
+    }
+
+    uint32_t received() { return static_cast<uint32_t>(seeds.size()); }
+
+    bool solve(std::vector<uint8_t>& source) {
+        if (blk_cnt == 0 || seeds.size() < blk_cnt) return false;
+
+        const auto n = seeds.size();
+        std::vector<std::vector<uint32_t>> eq_var(n), var_eq(blk_cnt);
+        std::vector<std::vector<uint8_t>> data(symbols);
+        std::vector<std::vector<uint64_t>> inact(n); // 方程中失活变量的系数
+        std::vector<uint32_t> degree(n);             // 方程中活跃变量的数量
+        std::vector<bool> used(n, false);
+
+        for (size_t e = 0; e < n; ++e) {
+            neighbors(seeds[e], eq_var[e]);
+            degree[e] = static_cast<uint32_t>(eq_var[e].size());
+            for (const auto v : eq_var[e]) var_eq[v].push_back(static_cast<uint32_t>(e));
+        }
+
+        constexpr uint32_t active = UINT32_MAX;
+        std::vector<uint32_t> solved(blk_cnt, active); // 求解该变量的方程
+        std::vector<uint32_t> inactive;                // 失活变量，下标即系数位置
+        std::vector<uint32_t> ripple;                  // 活跃变量仅剩一个的方程
+        for (size_t e = 0; e < n; ++e) if (degree[e] == 1) ripple.push_back(static_cast<uint32_t>(e));
+
+        auto resolved = [&](const uint32_t v) { return solved[v] != active; };
+        std::vector<bool> dropped(blk_cnt, false); // 已失活的变量
+        uint32_t remain = blk_cnt;
+
+        while (remain > 0) {
+            // 剥离：度为1的方程直接求解其唯一的活跃变量，并消去其他方程中的该变量
+            while (!ripple.empty() && remain > 0) {
+                const auto e = ripple.back();
+                ripple.pop_back();
+                if (used[e] || degree[e] != 1) continue;
+
+                const auto v = *std::ranges::find_if(eq_var[e], [&](const auto x) { return !resolved(x) && !dropped[x]; });
+                used[e] = true;
+                solved[v] = e;
+                --remain;
+
+                for (const auto f : var_eq[v]) {
+                    if (f == e || used[f]) continue;
+                    xor_into(data[f], data[e]);
+                    xor_into(inact[f], inact[e]);
+                    if (--degree[f] == 1) ripple.push_back(f);
+                }
+            }
+            if (remain == 0) break;
+
+            // 失活：选取度最小的未用方程，失活其除一个以外的所有活跃变量，使剥离继续
+            size_t best = n;
+            for (size_t e = 0; e < n; ++e) if (!used[e] && degree[e] > 0 && (best == n || degree[e] < degree[best])) best = e;
+            if (best == n) return false; // 剩余变量未被任何方程覆盖
+
+            bool keep = true;
+            for (const auto u : eq_var[best]) {
+                if (resolved(u) || dropped[u]) continue;
+                if (keep) { keep = false; continue; }
+
+                const auto bit = inactive.size();
+                inactive.push_back(u);
+                dropped[u] = true;
+                --remain;
+                for (const auto f : var_eq[u]) {
+                    if (used[f]) continue;
+                    if (inact[f].size() <= bit / 64) inact[f].resize(bit / 64 + 1, 0);
+                    inact[f][bit / 64] ^= 1ULL << (bit % 64);
+                    if (--degree[f] == 1) ripple.push_back(f);
+                }
+            }
+        }
+
+        // 未用方程只含失活变量，高斯消元求解失活变量
+        const auto m = inactive.size();
+        const auto words = (m + 63) / 64;
+        std::vector<uint32_t> rows;
+        for (size_t e = 0; e < n; ++e) if (!used[e]) {
+            inact[e].resize(words, 0);
+            rows.push_back(static_cast<uint32_t>(e));
+        }
+
+        std::vector<uint32_t> pivot(m, active);
+        for (size_t col = 0, r = 0; col < m; ++col) {
+            auto it = std::find_if(rows.begin() + static_cast<int64_t>(r), rows.end(), [&](const auto e) { return (inact[e][col / 64] >> (col % 64)) & 1; });
+            if (it == rows.end()) return false; // 秩不足，需要更多符号
+            std::iter_swap(rows.begin() + static_cast<int64_t>(r), it);
+
+            const auto p = rows[r];
+            for (const auto e : rows) {
+                if (e == p || ((inact[e][col / 64] >> (col % 64)) & 1) == 0) continue;
+                xor_into(inact[e], inact[p]);
+                xor_into(data[e], data[p]);
+            }
+            pivot[col] = p;
+            ++r;
+        }
+
+        // 回代：已求解变量的值为其方程的数据异或所含失活变量的值
+        source.assign(static_cast<size_t>(blk_cnt) * blk_len, 0);
+        for (size_t col = 0; col < m; ++col) std::ranges::copy(data[pivot[col]], source.begin() + static_cast<int64_t>(inactive[col]) * blk_len);
+        for (uint32_t v = 0; v < blk_cnt; ++v) {
+            if (!resolved(v)) continue;
+            const auto e = solved[v];
+            const auto dst = std::span{source}.subspan(static_cast<size_t>(v) * blk_len, blk_len);
+            std::ranges::copy(data[e], dst.begin());
+            for (size_t w = 0; w < inact[e].size(); ++w) for (auto bits = inact[e][w]; bits != 0; bits &= bits - 1) {
+                const auto col = w * 64 + std::countr_zero(bits);
+                xor_into(dst, std::span{source}.subspan(static_cast<size_t>(inactive[col]) * blk_len, blk_len));
+            }
+        }
+
+        source.resize(src_len);
+        return true;
+    }
+
+    void clean() {
+        src_len = 0;
+        blk_len = 0;
+        blk_cnt = 0;
+        head_len = 0;
+        std::vector<uint64_t>().swap(cdf);
+        std::vector<uint32_t>().swap(seeds);
+        std::vector<std::vector<uint8_t>>().swap(symbols);
+        std::unordered_set<uint32_t>().swap(seen);
+    }
+}
@@ -1,37 +1,120 @@
-#include <iostream>
+#include <array>
 #include <fstream>
-#include <format>
+#include <algorithm>
+#include <numbers>
 
 #include <opencv2/imgproc.hpp>
 #include <opencv2/imgcodecs.hpp>
 
 #include <qrb/qr.h>
+#include <qrb/bilevel.h>
+#include <qrb/vector.h>
+#include <qrb/probe.h>
+#include <qrb/progress.h>
 #include <qrb/page.h>
 
 namespace {
-    constexpr float tolerance = 1.0f / 16.0f; // 误差容忍度，应大于0且小于1
-    constexpr double roi_scale = 1.15;        // 识别区域扩展系数，应大于1且小于1.5，否则会干扰掩码工作
+    constexpr int num_plane = 3;              // 彩色页的平面数，依次为青、品红、黄
+    constexpr int patch_ratio = 16;           // 校准色块条的高为页宽的1/16，白、青、品红、黄四个色块各占1/4页宽
+
+    const std::array<cv::Scalar, 4> swatch = {cv::Scalar(255, 255, 255), cv::Scalar(255, 255, 0), cv::Scalar(255, 0, 255), cv::Scalar(0, 255, 255)}; // BGR
 
     int num_col = 0; // 每列二维码数量
     int num_row = 0; // 每行二维码数量
     int page_cap = 0;
+    int num_cell = 0; // 每页网格单元数
+    bool colour = false; // 三通道彩色页，每个网格单元在各平面各放一个二维码
     int page_w = 0; // 页宽像素
     int page_h = 0; // 页高像素
+    qrb::page::params setting; // 解码参数
 
     cv::Mat buffer;
-
-    cv::Mat preprocess (const cv::Mat& img) { // 预处理待解码的图像
-        cv::Mat result(static_cast<int>(img.rows * roi_scale), static_cast<int>(img.cols * roi_scale), CV_8UC1, cv::Scalar(255, 255, 255));
-
-        cv::Mat gray, denoise;
-        cvtColor(img, gray, cv::COLOR_BGR2GRAY);
-        cv::bilateralFilter(gray, denoise, 5, 30, 30); // 经验值
+    std::array<cv::Mat, num_plane> planes; // 彩色页各平面的灰度图像，黑色即该平面的墨水
+    uint64_t refused = 0; // 分带识别时检测到的彩色页数
+    std::vector<cv::Mat> modules; // 二值或矢量输出时每个二维码的模块矩阵，按页复用
+    std::vector<cv::Rect> rects;  // 矢量输出时的黑色矩形，按页复用
+    cv::Mat inverse;              // 取反后的模块矩阵，黑色为0，校验时按页复用
+    cv::Mat written;              // 校验时从文件读回的页图像，不占用图像缓冲
+
+    cv::Mat preprocess (const cv::Mat& img) { // 预处理待解码的灰度图像
+        qrb::probe::zone zone("preprocess");
+        cv::Mat result(static_cast<int>(img.rows * setting.roi_scale), static_cast<int>(img.cols * setting.roi_scale), CV_8UC1, cv::Scalar(255, 255, 255));
+
+        cv::Mat denoise;
+        if (setting.filter_d > 0) cv::bilateralFilter(img, denoise, setting.filter_d, setting.filter_sigma, setting.filter_sigma);
+        else denoise = img;
+        if (setting.binarizer == 1) cv::threshold(denoise, denoise, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+        else if (setting.binarizer == 2) cv::adaptiveThreshold(denoise, denoise, 255, cv::ADAPTIVE_THRESH_MEAN_C, cv::THRESH_BINARY, (std::max(img.cols, img.rows) / 64) | 1, 10); // 邻域约为页面长边的1/64
         denoise.copyTo(result(cv::Rect{(result.cols - img.cols) / 2, (result.rows - img.rows) / 2, img.cols, img.rows}));
 
         return result;
     }
 
+    void compose() { // 青、品红、黄墨水分别吸收红、绿、蓝光，各平面依次写入R、G、B通道，再在页底绘制校准色块
+        cv::merge(std::vector{planes[2], planes[1], planes[0]}, buffer);
+
+        const int h = page_w / patch_ratio;
+        for (int k = 0; k < 4; ++k) cv::rectangle(buffer, cv::Rect{k * page_w / 4, page_h - h, (k + 1) * page_w / 4 - k * page_w / 4, h}, swatch[k], -1);
+    }
+
+    bool striped(const cv::Mat& gray) { // 灰度图像底部是否为彩色页的校准色块，白、青、品红、黄的亮度约为255、179、105、226，各自均匀
+        const int h = gray.cols / patch_ratio;
+        if (h < 4 || gray.rows <= 2 * h) return false;
+        std::array<double, 4> level{};
+        for (int k = 0; k < 4; ++k) { // 与calibrate取相同的色块中心
+            cv::Scalar mean, dev;
+            cv::meanStdDev(gray(cv::Rect{k * gray.cols / 4 + gray.cols / 16, gray.rows - h * 3 / 4, gray.cols / 8, h / 2}), mean, dev);
+            if (dev[0] > 24.0) return false; // 黑白页底部为二维码或留白，不会有均匀的中间灰度
+            level[k] = mean[0];
+        }
+        return level[2] > 32.0 && level[2] < level[1] && level[1] < level[3] && level[3] < level[0] && level[0] - level[2] > 64.0;
+    }
+
+    bool calibrate(const cv::Mat& img, cv::Matx34f& unmix) { // 由页底色块估计分离各平面的仿射变换，输出通道依次为青、品红、黄平面
+        qrb::probe::zone zone("calibrate");
+        const int h = img.cols / patch_ratio;
+        std::array<cv::Vec3d, 4> color{}; // 实测的白、青、品红、黄
+        bool found = h >= 4 && img.rows > 2 * h;
+        for (int k = 0; found && k < 4; ++k) { // 只取色块中心，容忍轻微的裁切与偏移
+            const auto m = cv::mean(img(cv::Rect{k * img.cols / 4 + img.cols / 16, img.rows - h * 3 / 4, img.cols / 8, h / 2}));
+            color[k] = {m[0], m[1], m[2]};
+        }
+
+        cv::Matx33d absorb; // 各墨水相对纸白的吸收量，行依次为B、G、R通道，列依次为青、品红、黄
+        for (int k = 0; found && k < num_plane; ++k) {
+            const int t = 2 - k; // 该墨水主要吸收的通道
+            for (int c = 0; c < 3; ++c) absorb(c, k) = color[0][c] - color[k + 1][c];
+            for (int c = 0; c < 3; ++c) if (c != t && absorb(c, k) * 2 > absorb(t, k)) found = false;
+            if (absorb(t, k) < 64.0) found = false;
+        }
+
+        if (!found) { // 照片中色块位置不确定，饱和像素足够多时仍视为彩色页，按理想墨色分离
+            int total = 0, vivid = 0;
+            for (int y = 0; y < img.rows; y += 4) {
+                const auto* p = img.ptr<cv::Vec3b>(y);
+                for (int x = 0; x < img.cols; x += 4, ++total) {
+                    const auto [lo, hi] = std::minmax({p[x][0], p[x][1], p[x][2]});
+                    vivid += hi - lo > 96;
+                }
+            }
+            if (vivid * 50 < total) return false; // 饱和像素不足2%视为黑白页
+
+            color[0] = {255.0, 255.0, 255.0};
+            absorb = cv::Matx33d(0.0, 0.0, 255.0, 0.0, 255.0, 0.0, 255.0, 0.0, 0.0);
+        }
+
+        // 平面浓度 a = absorb^-1 * (白 - 像素)，平面灰度为 255 * (1 - a)
+        const auto inv = absorb.inv();
+        const cv::Vec3d base = inv * color[0];
+        for (int k = 0; k < num_plane; ++k) {
+            for (int c = 0; c < 3; ++c) unmix(k, c) = static_cast<float>(255.0 * inv(k, c));
+            unmix(k, 3) = static_cast<float>(255.0 - 255.0 * base[k]);
+        }
+        return true;
+    }
+
     void save(const fs::path& file) { // 写图像缓冲到文件
+        qrb::probe::zone zone("save");
         std::vector<uint8_t> binary;
         if (!cv::imencode(file.extension().string(), buffer, binary, {cv::IMWRITE_PNG_COMPRESSION, 4})) return;
 
@@ -41,9 +124,59 @@ namespace {
         output.close();
     }
 
-    void load(const fs::path& file) { // 读文件到图像缓冲
+    void save(const fs::path& file, const size_t count) { // 由模块矩阵逐行生成1位像素写到文件，不经过图像缓冲
+        qrb::probe::zone zone("save");
+        const int cell = qrb::qr::px() + qrb::qr::sp();
+        const int dim = modules.front().rows;
+        int key = -2; // 当前行缓冲对应的网格行与模块行，-1为空白行
+
+        qrb::bilevel::write(file, page_w, page_h, [&](const int y, const std::span<uint8_t> row) {
+            const int j = (y - qrb::qr::sp()) / cell;
+            const int py = y < qrb::qr::sp() ? -1 : (y - qrb::qr::sp()) % cell - qrb::qr::border(); // 二维码内去除留白后的像素行
+            const int k = py >= 0 && py < dim * qrb::qr::unit() && j < num_row ? j * dim + py / qrb::qr::unit() : -1;
+            if (k == key) return; // 缩放产生的重复行直接复用
+            key = k;
+
+            std::ranges::fill(row, 0);
+            if (k < 0) return;
+
+            for (size_t i = j * num_col, end = std::min(count, static_cast<size_t>(j + 1) * num_col); i < end; ++i) {
+                const auto* src = modules[i].ptr<uint8_t>(py / qrb::qr::unit());
+                const int x0 = static_cast<int>(i % num_col) * cell + qrb::qr::sp() + qrb::qr::border();
+                for (int x = 0; x < dim; ++x) {
+                    if (src[x] == 0) continue;
+                    for (int p = x0 + x * qrb::qr::unit(), e = p + qrb::qr::unit(); p < e; ++p) row[p >> 3] |= static_cast<uint8_t>(0x80 >> (p & 7));
+                }
+            }
+        });
+    }
+
+    void trace(const fs::path& file, const size_t count) { // 将模块矩阵每行的连续黑色模块合并为矩形写到文件
+        qrb::probe::zone zone("save");
+        const int cell = qrb::qr::px() + qrb::qr::sp();
+        const int unit = qrb::qr::unit();
+
+        rects.clear();
+        for (size_t i = 0; i < count; ++i) {
+            const auto& m = modules[i];
+            const int x0 = static_cast<int>(i % num_col) * cell + qrb::qr::sp() + qrb::qr::border();
+            const int y0 = static_cast<int>(i / num_col) * cell + qrb::qr::sp() + qrb::qr::border();
+            for (int y = 0; y < m.rows; ++y) {
+                const auto* src = m.ptr<uint8_t>(y);
+                for (int a = 0, b = 0; a < m.cols; a = b) {
+                    for (b = a + 1; b < m.cols && (src[b] != 0) == (src[a] != 0); ++b) {}
+                    if (src[a] != 0) rects.emplace_back(x0 + a * unit, y0 + y * unit, (b - a) * unit, unit);
+                }
+            }
+        }
+
+        qrb::vector::write(file, page_w, page_h, rects);
+    }
+
+    cv::Mat load(const fs::path& file, const int mode) { // 读文件并解码为图像，失败时为空
+        qrb::probe::zone zone("load");
         std::ifstream input(file, std::ios::binary | std::ios::ate);
-        if (!input.is_open()) {buffer.release(); return;}
+        if (!input.is_open()) return {};
         const auto file_size = input.tellg();
         input.seekg(0);
 
@@ -51,11 +184,16 @@ namespace {
         input.read(reinterpret_cast<char*>(binary.data()), file_size);
         input.close();
 
-        buffer = cv::imdecode(binary, cv::IMREAD_COLOR_BGR); // 固定三通道图像
+        return cv::imdecode(binary, mode);
+    }
+
+    bool attempt(const size_t k) { // 每组识别区域中是否尝试第k个，首个为原始区域，最后一个为四边均扩展的区域
+        return setting.roi_tries == 16 || k == 0 || (setting.roi_tries == 2 && k == 15);
     }
 
     std::vector<cv::Rect> segment(const cv::Mat& img, const std::vector<cv::Rect>& box, const bool scale_only) { // 生成识别网格
         assert(!img.empty() && !box.empty());
+        qrb::probe::zone zone("segment");
 
         std::array<std::vector<float>, 2> center{}; // 二维码区域原始中心点
         for (const auto& b : box) {
@@ -77,7 +215,7 @@ namespace {
             for (size_t i = 0, j = 0; i < center[c].size(); i = j) {
                 float sum = center[c][i];
                 for (j = i + 1; j < center[c].size(); ++j) {
-                    if ((center[c][j] - center[c][j - 1]) / box_wh[c] > tolerance) break;
+                    if ((center[c][j] - center[c][j - 1]) / box_wh[c] > setting.tolerance) break;
                     sum += center[c][j];
                 }
                 center_xy[c].push_back(sum / static_cast<float>(j - i));
@@ -91,7 +229,7 @@ namespace {
             int count = 0;
             for (size_t i = 1; i < center_xy[c].size(); ++i) {
                 const float gap = center_xy[c][i] - center_xy[c][i - 1];
-                if (const float r = gap / box_wh[c] / qrb::qr::ratio(); r < 1.0f - tolerance || r > 1.0f + tolerance) continue;
+                if (const float r = gap / box_wh[c] / qrb::qr::ratio(); r < 1.0f - setting.tolerance || r > 1.0f + setting.tolerance) continue;
                 est += gap;
                 ++count;
             }
@@ -100,8 +238,8 @@ namespace {
         }
 
         const cv::Point tl{static_cast<int>(center_xy[0][0]) % grid_wh[0], static_cast<int>(center_xy[1][0]) % grid_wh[1]};
-        const std::array<int, 2> roi_w {grid_wh[0], static_cast<int>(roi_scale * grid_wh[0])};
-        const std::array<int, 2> roi_h {grid_wh[1], static_cast<int>(roi_scale * grid_wh[1])};
+        const std::array<int, 2> roi_w {grid_wh[0], static_cast<int>(setting.roi_scale * grid_wh[0])};
+        const std::array<int, 2> roi_h {grid_wh[1], static_cast<int>(setting.roi_scale * grid_wh[1])};
 
         std::vector<cv::Rect> result;
         for (int j = 0; j < (img.rows / grid_wh[1] + 1); ++j) {
@@ -122,56 +260,71 @@ namespace {
 
         return result;
     }
-}
 
-namespace qrb::page {
-    void config(const int n_col, const int n_row) {
-        num_col = n_col;
-        num_row = n_row;
-
-        page_cap = num_col * num_row;
-        page_w = num_col * (qr::px() + qr::sp()) + qr::sp();
-        page_h = num_row * (qr::px() + qr::sp()) + qr::sp();
-
-        buffer = cv::Mat(page_h, page_w, CV_8UC1, cv::Scalar(255)); // 固定单通道灰度图像
-    }
-
-    int cap() { return page_cap; }
-
-    void write(const std::span<const uint8_t> data, const fs::path& file) {
-        if (data.empty() || page_cap * qr::cap() < data.size()) return;
-
-        if (page_cap != (data.size() + qr::cap() - 1) / qr::cap()) buffer.setTo(255); // 无法填满页面时，不清空则会残留上一页的部分图像
-        size_t offset = 0, remain = data.size();
-
-        while (remain > 0) {
-            const auto idx = offset / qr::cap();
-            const int x = static_cast<int>(idx % num_col) * (qr::px() + qr::sp()) + qr::sp();
-            const int y = static_cast<int>(idx / num_col) * (qr::px() + qr::sp()) + qr::sp();
-
-            const auto len = remain >= qr::cap() ? qr::cap() : remain;
-            auto roi = buffer(cv::Rect{x, y, qr::px(), qr::px()});
-            qr::encode(data.subspan(offset, len), roi);
-
-            offset += len;
-            remain -= len;
+    bool exact(const cv::Mat& img, const size_t expect, std::vector<std::vector<uint8_t>>& result) { // 按格点采样未经缩放与拍摄的黑白页，不符合版式或有非空白单元无法解码时返回false
+        qrb::probe::zone zone("exact");
+        cv::Point tl{-1, -1}; // 首个黑色像素，即第一个二维码的左上角
+        for (int y = 0; y < img.rows; ++y) { // 只含接近纯黑与纯白的像素，照片通常在前几个像素即可排除
+            const auto* p = img.ptr<uint8_t>(y);
+            for (int x = 0; x < img.cols; ++x) {
+                if (p[x] > 48 && p[x] < 207) return false;
+                if (p[x] < 128 && tl.y < 0) tl = {x, y};
+            }
         }
+        if (tl.y < 0) return false;
+
+        const auto* top = img.ptr<uint8_t>(tl.y); // 定位图案首行为7个黑色模块
+        int run = 0;
+        while (tl.x + run < img.cols && top[tl.x + run] < 128) ++run;
+        const int unit = run / 7;
+        if (unit == 0 || run % 7 != 0 || tl.y + 7 * unit > img.rows) return false;
+
+        const auto* timing = img.ptr<uint8_t>(tl.y + 6 * unit + unit / 2); // 定位图案末行与时序图案所在行，内部的白色至多为1个模块
+        int end = tl.x;
+        for (int x = tl.x, white = 0; x < img.cols && white < 2 * unit; ++x) {
+            if (timing[x] < 128) { end = x + 1; white = 0; }
+            else ++white;
+        }
+        const int dim = (end - tl.x) / unit;
+        if ((end - tl.x) % unit != 0 || dim < 21 || dim > 177 || (dim - 17) % 4 != 0) return false;
+
+        // 与qr的版式一致：留白固定，间隔由版本决定
+        const int margin = qrb::qr::border() / qrb::qr::unit();
+        const int sp = (dim / 8 - margin) * unit, pitch = (dim + 2 * margin) * unit + sp;
+        const int cols = (img.cols - sp) / pitch, rows = (img.rows - sp) / pitch;
+        if (tl.x != sp + margin * unit || tl.y != tl.x || cols < 1 || rows < 1 || img.cols != cols * pitch + sp || img.rows != rows * pitch + sp) return false;
+
+        std::vector<std::vector<uint8_t>> found;
+        const auto full = [&] { return expect != 0 && result.size() + found.size() >= expect; };
+        for (int j = 0; j < rows && !full(); ++j) {
+            for (int i = 0; i < cols && !full(); ++i) {
+                const cv::Point origin{tl.x + i * pitch, tl.y + j * pitch};
+                if (img.ptr<uint8_t>(origin.y)[origin.x] < 128) { // 左上角为定位图案，白色时为空白单元，无需解码
+                    if (auto data = qrb::qr::sample(img, origin, dim, unit, true); !data.empty()) {
+                        found.push_back(std::move(data));
+                        continue;
+                    }
+                }
+                double min_px = 0.0; // 末页未填满的单元为空白
+                if (cv::minMaxLoc(img(cv::Rect{origin.x, origin.y, dim * unit, dim * unit}), &min_px); min_px < 128.0) return false;
+            }
+        }
+        if (found.empty()) return false;
 
-        save(file);
+        result.insert(result.end(), std::make_move_iterator(found.begin()), std::make_move_iterator(found.end()));
+        return true;
     }
 
-    std::vector<std::vector<uint8_t>> read(const fs::path& file) {
-        load(file);
-        if (buffer.empty()) return {};
-
-        cv::Mat ori = buffer, page = preprocess(ori);
+    // 识别一幅灰度图像，已识别个数达到expect时返回true
+    // known为已识别二维码在ori中的位置，其中心落在这些区域内的结果视为重复，结束时替换为本次与已知的全部位置
+    bool scan(const cv::Mat& ori, const size_t expect, const double share, std::vector<std::vector<uint8_t>>& result, double& progress, std::vector<cv::Rect>& known) {
+        const cv::Mat page = preprocess(ori);
+        const cv::Point shift{(page.cols - ori.cols) / 2, (page.rows - ori.rows) / 2}; // ori在page中的偏移
 
-        std::vector<std::vector<uint8_t>> result;
-        std::vector<cv::Rect> ref, roi;
+        std::vector<cv::Rect> ref, roi, carried;
+        for (const auto& b : known) carried.emplace_back(b.x + shift.x, b.y + shift.y, b.width, b.height);
         cv::Mat roi_mask(page.size(), CV_8UC1, cv::Scalar(255));
-        rectangle(roi_mask, cv::Rect{(page.cols - ori.cols) / 2, (page.rows - ori.rows) / 2, ori.cols, ori.rows}, cv::Scalar(0), -1);
-
-        double progress = 0.0;
+        rectangle(roi_mask, cv::Rect{shift.x, shift.y, ori.cols, ori.rows}, cv::Scalar(0), -1);
 
         auto decode_and_update = [&](const bool single) {
             // 计算或修正网格分布
@@ -191,31 +344,54 @@ namespace qrb::page {
                     // 不再重复识别
                     double min_px = 0.0;
                     if (cv::minMaxLoc(roi_mask(roi[j]), &min_px); min_px == 255.0) break;
+                    if (!attempt(j - i)) continue;
                     // 解码当前区域
-                    auto [data, box] = qr::decode(page(roi[j]), single);
+                    qrb::probe::count("roi_attempts");
+                    auto [data, box] = [&] {
+                        qrb::probe::zone zone("roi");
+                        return qrb::qr::decode(page(roi[j]), single);
+                    }();
                     if (data.empty() || box.empty()) continue;
-                    // 填充结果
-                    for (auto& b : box) {
+                    qrb::probe::count("roi_successes");
+                    // 填充结果，跳过已知的二维码
+                    for (size_t n = 0; n < data.size() && n < box.size(); ++n) {
+                        auto b = box[n];
                         b.x += roi[j].x;
                         b.y += roi[j].y;
+                        if (std::ranges::any_of(carried, [&](const cv::Rect& c) { return c.contains((b.tl() + b.br()) / 2); })) continue;
+                        result.push_back(std::move(data[n]));
+                        ref.push_back(b);
                     }
-                    result.insert(result.end(), data.begin(), data.end());
-                    ref.insert(ref.end(), box.begin(), box.end());
                     break;
                 }
 
-                progress += 33.3 * 16 / static_cast<double>(roi.size());
-                std::cout << "\r" << std::format(" {:>4.1f}%", progress) << std::flush;
+                progress += 33.3 * 16 * share / static_cast<double>(roi.size());
+                qrb::progress::part(progress / 100.0);
             }
         };
 
-        // 整体识别
+        // 以已识别二维码外接矩形的最短边估计模块像素，作为定位图案查找的行距依据
+        // 旋转45°时外接矩形为二维码边长的√2倍，按此缩小估计值，任意角度下行距都不超过1个模块
+        const auto hint = [](const std::vector<cv::Rect>& boxes) {
+            const int dim = qrb::qr::unit() > 0 ? (qrb::qr::px() - 2 * qrb::qr::border()) / qrb::qr::unit() : 0; // 每边的模块数
+            int side = 0;
+            for (const auto& b : boxes) if (const int s = std::min(b.width, b.height); side == 0 || s < side) side = s;
+            qrb::qr::hint(dim > 0 ? static_cast<int>(side / (dim * std::numbers::sqrt2)) : 0);
+        };
+
+        // 整体识别，分带时沿用上一带已识别的尺寸
+        hint(carried);
         ref.emplace_back((page.cols - ori.cols) / 2, (page.rows - ori.rows) / 2, ori.cols, ori.rows); // 初始区域为扩展前的原始图像
         decode_and_update(false);
         ref.erase(ref.begin());
+        ref.insert(ref.end(), carried.begin(), carried.end()); // 已知位置参与网格计算，并在之后各轮中被掩码跳过
+        if (expect != 0 && result.size() >= expect) return true;
+        hint(ref);
         // 计算网格分布，独立识别，并利用可能得到的新信息修正网格分布，再次独立识别，减少遗漏
-        decode_and_update(true);
-        decode_and_update(true);
+        if (setting.passes >= 2) decode_and_update(true);
+        if (expect != 0 && result.size() >= expect) return true;
+        hint(ref);
+        if (setting.passes >= 3) decode_and_update(true);
 
         // // 标记识别情况
         // for (auto& b : ref) {
@@ -225,6 +401,188 @@ namespace qrb::page {
         // }
         // if (!ref.empty()) save(file);
 
+        known.clear();
+        for (const auto& b : ref) known.emplace_back(b.x - shift.x, b.y - shift.y, b.width, b.height);
+        return expect != 0 && result.size() >= expect;
+    }
+
+    void stream(const cv::Mat& gray, const size_t expect, std::vector<std::vector<uint8_t>>& result) { // 按相互重叠的水平带依次识别，已识别的位置与网格行距由上一带传递
+        std::vector<cv::Rect> known; // 已识别二维码在当前带中的位置
+        double progress = 0.0;
+        int pitch = 0; // 网格行距，识别到首个二维码之前未知
+
+        // 行距未知时带高取页宽的2倍并重叠一半，单列网格的二维码也能完整落在某一带中
+        for (int y = 0, h = std::min(gray.rows, 2 * gray.cols); y < gray.rows;) {
+            if (pitch != 0) h = (setting.band + 1) * pitch;
+            h = std::min(h, gray.rows - y);
+            if (scan(gray.rowRange(y, y + h), expect, static_cast<double>(h) / gray.rows, result, progress, known)) return;
+            if (y + h >= gray.rows) return;
+
+            if (pitch == 0 && !known.empty()) {
+                double sum = 0.0;
+                for (const auto& b : known) sum += b.height;
+                pitch = std::max(1, static_cast<int>(sum / static_cast<double>(known.size()) * qrb::qr::ratio()));
+            }
+
+            const int step = pitch != 0 ? std::max(1, h - pitch) : std::max(1, h / 2); // 重叠部分不小于一行网格，跨越带边界的二维码在下一带中完整出现
+            for (auto& b : known) b.y -= step;
+            std::erase_if(known, [](const cv::Rect& b) { return b.y + b.height <= 0; });
+            y += step;
+        }
+    }
+}
+
+namespace qrb::page {
+    void config(const int n_col, const int n_row, const bool use_colour) {
+        num_col = n_col;
+        num_row = n_row;
+        colour = use_colour;
+
+        num_cell = num_col * num_row;
+        page_cap = num_cell * (colour ? num_plane : 1);
+        page_w = num_col * (qr::px() + qr::sp()) + qr::sp();
+        page_h = num_row * (qr::px() + qr::sp()) + qr::sp();
+
+        if (!colour) {
+            buffer = cv::Mat(page_h, page_w, CV_8UC1, cv::Scalar(255)); // 固定单通道灰度图像
+            return;
+        }
+
+        page_h += 2 * qr::border() + page_w / patch_ratio; // 网格下方留白后为校准色块条
+        for (auto& p : planes) p = cv::Mat(page_h, page_w, CV_8UC1, cv::Scalar(255));
+        buffer = cv::Mat(page_h, page_w, CV_8UC3, cv::Scalar(255, 255, 255));
+    }
+
+    int cap() { return page_cap; }
+
+    bool tune(const params& p) {
+        if (p.tolerance <= 0.0f || p.tolerance >= 1.0f || p.roi_scale <= 1.0 || p.roi_scale >= 1.5) return false;
+        if ((p.roi_tries != 1 && p.roi_tries != 2 && p.roi_tries != 16) || p.passes < 1 || p.passes > 3) return false;
+        if (p.filter_d < 0 || p.filter_sigma <= 0.0 || p.binarizer < 0 || p.binarizer > 2 || p.band < 0) return false;
+
+        setting = p;
+        qr::strategy(p.try_harder);
+        return true;
+    }
+
+    const params& tuned() { return setting; }
+
+    bool writable(const std::string& ext) {
+        if (colour) return ext != ".pbm" && ext != ".pgm" && !vector::support(ext) && cv::haveImageWriter(ext); // 彩色页只能经图像缓冲输出
+        return bilevel::support(ext) || vector::support(ext) || cv::haveImageWriter(ext);
+    }
+
+    void write(const std::span<const uint8_t> data, const fs::path& file) {
+        if (data.empty() || page_cap * qr::cap() < data.size()) return;
+        probe::zone zone("page::write", file);
+
+        if (const auto ext = file.extension().string(); !colour && (bilevel::support(ext) || vector::support(ext))) { // 二值与矢量格式直接由模块矩阵生成
+            const auto count = (data.size() + qr::cap() - 1) / qr::cap();
+            if (modules.size() < count) modules.resize(count);
+            for (size_t i = 0; i < count; ++i) {
+                const auto offset = i * qr::cap();
+                qr::matrix(data.subspan(offset, std::min(static_cast<size_t>(qr::cap()), data.size() - offset)), modules[i]);
+            }
+
+            if (vector::support(ext)) trace(file, count);
+            else save(file, count);
+            return;
+        }
+
+        if (page_cap != (data.size() + qr::cap() - 1) / qr::cap()) { // 无法填满页面时，不清空则会残留上一页的部分图像
+            if (colour) for (auto& p : planes) p.setTo(255);
+            else buffer.setTo(255);
+        }
+        size_t offset = 0, remain = data.size();
+
+        while (remain > 0) {
+            const auto idx = offset / qr::cap();
+            const auto cell = idx % num_cell; // 彩色页先填满青色平面，再依次填品红与黄色平面
+            const int x = static_cast<int>(cell % num_col) * (qr::px() + qr::sp()) + qr::sp();
+            const int y = static_cast<int>(cell / num_col) * (qr::px() + qr::sp()) + qr::sp();
+
+            const auto len = remain >= qr::cap() ? qr::cap() : remain;
+            auto roi = (colour ? planes[idx / num_cell] : buffer)(cv::Rect{x, y, qr::px(), qr::px()});
+            qr::encode(data.subspan(offset, len), roi);
+
+            offset += len;
+            remain -= len;
+        }
+
+        if (colour) compose();
+        save(file);
+    }
+
+    bool check(const std::span<const uint8_t> data, const fs::path& file) {
+        probe::zone zone("page::check", file);
+        const int cell = qr::px() + qr::sp();
+        const int dim = (qr::px() - 2 * qr::border()) / qr::unit();
+        const bool direct = !colour && vector::support(file.extension().string()); // 矢量文档不经光栅化无法读回，采样生成它的模块矩阵
+
+        std::vector<cv::Mat> split;
+        if (!direct) { // 光栅图像从文件读回，有损压缩或写出失败都会体现在解码结果中
+            written = load(file, colour ? cv::IMREAD_COLOR_BGR : cv::IMREAD_GRAYSCALE);
+            if (written.cols != page_w || written.rows != page_h) return false;
+            if (cv::Matx34f unmix; colour) { // 彩色页与识别时相同，由色块分离各平面
+                if (!calibrate(written, unmix)) return false;
+                cv::Mat separate;
+                cv::transform(written, separate, unmix);
+                cv::split(separate, split);
+            }
+        }
+
+        for (size_t i = 0, offset = 0; offset < data.size(); ++i, offset += qr::cap()) {
+            const auto expected = data.subspan(offset, std::min(static_cast<size_t>(qr::cap()), data.size() - offset));
+            std::vector<uint8_t> decoded;
+            if (direct) {
+                if (i >= modules.size()) return false;
+                cv::bitwise_not(modules[i], inverse);
+                decoded = qr::sample(inverse, {0, 0}, dim, 1);
+            } else {
+                const auto k = i % num_cell;
+                const cv::Point origin{static_cast<int>(k % num_col) * cell + qr::sp() + qr::border(), static_cast<int>(k / num_col) * cell + qr::sp() + qr::border()};
+                decoded = qr::sample(colour ? split[i / num_cell] : written, origin, dim, qr::unit());
+            }
+            if (!std::ranges::equal(decoded, expected)) return false;
+        }
+
+        return true;
+    }
+
+    void close() { vector::close(); }
+
+    uint64_t rejected() { return refused; }
+
+    std::vector<std::vector<uint8_t>> read(const fs::path& file, const size_t expect) {
+        probe::zone zone("page::read", file);
+        buffer = load(file, setting.band > 0 ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR_BGR); // 分带识别时不保留三通道图像
+        if (buffer.empty()) return {};
+        if (setting.band > 0 && striped(buffer)) { // 分带识别只处理灰度图像，由底部的校准色块检测彩色页并拒绝，而非当作黑白页识别失败
+            ++refused;
+            return {};
+        }
+
+        std::vector<std::vector<uint8_t>> result;
+        std::vector<cv::Rect> known;
+        double progress = 0.0;
+
+        if (setting.band > 0) {
+            if (!exact(buffer, expect, result)) stream(buffer, expect, result);
+        } else if (cv::Matx34f unmix; calibrate(buffer, unmix)) { // 彩色页分离为各平面，依次按灰度图像识别
+            cv::Mat separate;
+            std::vector<cv::Mat> split;
+            cv::transform(buffer, separate, unmix);
+            cv::split(separate, split);
+            for (const auto& p : split) {
+                known.clear();
+                if (scan(p, expect, 1.0 / num_plane, result, progress, known)) break;
+            }
+        } else {
+            cv::Mat gray;
+            cvtColor(buffer, gray, cv::COLOR_BGR2GRAY);
+            if (!exact(gray, expect, result)) scan(gray, expect, 1.0, result, progress, known);
+        }
+
         return result;
     }
 }
\ No newline at end of file
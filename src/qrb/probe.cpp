@@ -0,0 +1,306 @@
+#include <iostream>
+#include <fstream>
+#include <format>
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <array>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <QRReader.h>
+
+#include <qrb/probe.h>
+
+namespace {
+    constexpr size_t num_pmu = 6; // 依次为周期、指令、L1数据缓存读未命中、末级缓存读未命中、分支、分支预测失败
+    using pmu_t = std::array<uint64_t, num_pmu>;
+
+    using counts_t = std::map<std::string, int64_t>;
+
+    struct event { // 一个计时区间，时间均为相对开启时刻的纳秒数，硬件计数为区间内的增量，计数器为区间内直接累加的值
+        const char* name;
+        std::string detail;
+        int64_t beg;
+        int64_t dur;
+        pmu_t pmu;
+        counts_t counts;
+    };
+
+    struct frame { // 尚未结束的区间
+        const char* name;
+        std::string detail;
+        int64_t beg;
+        pmu_t pmu;
+        counts_t counts;
+    };
+
+    struct record { // 单个线程的记录，只由该线程追加
+        uint32_t tid = 0;
+        std::vector<event> events;
+        counts_t counts;         // 计数器合计，含不在任何区间内的累加
+        std::vector<frame> open; // 区间严格嵌套，按栈配对
+        int leader = -1;         // 硬件计数器组的首个文件描述符，-1表示不可用
+        std::array<int, num_pmu> slot{}; // 各计数在组读取结果中的位置，-1表示该计数不可用
+        std::vector<int> fds;    // 组内全部计数器的文件描述符，随记录释放时关闭
+
+        record() = default;
+        record(const record&) = delete;
+        record& operator=(const record&) = delete;
+        ~record() { release(); }
+
+        void release() { // 关闭计数器组，之后的区间不再读取硬件计数
+#ifdef __linux__
+            for (const auto fd : fds) close(fd);
+#endif
+            fds.clear();
+            leader = -1;
+        }
+    };
+
+    bool active = false;
+    bool use_pmu = false;
+    bool pmu_ok = false; // 至少一个线程成功打开了计数器组
+    fs::path trace_file;
+    std::chrono::steady_clock::time_point origin;
+
+    std::mutex lock;
+    std::vector<std::unique_ptr<record>> logs; // 各线程的记录，线程结束后仍保留到输出
+    thread_local record* local = nullptr;
+
+    int64_t now() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count(); }
+
+    void attach(record& r) { // 为当前线程打开计数器组，只统计用户态，组内计数同时调度，比值不受复用影响
+        r.slot.fill(-1);
+#ifdef __linux__
+        constexpr auto cache = [](const uint64_t id) { return id | PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16; };
+        const std::array<std::pair<uint32_t, uint64_t>, num_pmu> config = {{
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_L1D)},
+            {PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_LL)},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        }};
+
+        int count = 0;
+        for (size_t k = 0; k < num_pmu; ++k) {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = config[k].first;
+            attr.config = config[k].second;
+            attr.read_format = PERF_FORMAT_GROUP;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+
+            const int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, r.leader, 0));
+            if (fd < 0) {
+                if (k == 0) return; // 周期计数不可用时整组放弃
+                continue;
+            }
+            if (k == 0) r.leader = fd;
+            r.fds.push_back(fd);
+            r.slot[k] = count++;
+        }
+        pmu_ok = true;
+#endif
+    }
+
+    pmu_t read_pmu(const record& r) {
+        pmu_t result{};
+#ifdef __linux__
+        if (r.leader < 0) return result;
+        std::array<uint64_t, num_pmu + 1> buffer{}; // 首项为组内计数个数
+        if (::read(r.leader, buffer.data(), sizeof(buffer)) <= 0) return result;
+        for (size_t k = 0; k < num_pmu; ++k) if (r.slot[k] >= 0) result[k] = buffer[r.slot[k] + 1];
+#endif
+        return result;
+    }
+
+    record& current() {
+        if (local == nullptr) {
+            const std::lock_guard guard(lock);
+            logs.push_back(std::make_unique<record>());
+            local = logs.back().get();
+            local->tid = static_cast<uint32_t>(logs.size());
+            if (use_pmu) attach(*local);
+        }
+        return *local;
+    }
+
+    void begin(const char* name, std::string detail) {
+        auto& r = current();
+        r.open.push_back({name, std::move(detail), now(), read_pmu(r), {}});
+    }
+
+    void end() {
+        auto& r = current();
+        if (r.open.empty()) return;
+
+        const auto pmu = read_pmu(r);
+        const auto t = now();
+        auto& f = r.open.back();
+        event e{f.name, std::move(f.detail), f.beg, t - f.beg, {}, std::move(f.counts)};
+        for (size_t k = 0; k < num_pmu; ++k) e.pmu[k] = pmu[k] - f.pmu[k];
+        r.open.pop_back();
+        r.events.push_back(std::move(e));
+    }
+
+    void hook_zone(const char* name, const bool start) {
+        if (start) begin(name, {});
+        else end();
+    }
+
+    void hook_count(const char* name, const long long value) { qrb::probe::count(name, value); }
+
+    std::string escape(const std::string& str) { // JSON字符串转义，非ASCII字符按UTF-8原样输出
+        std::string result;
+        for (const char c : str) {
+            if (c == '"' || c == '\\') result += {'\\', c};
+            else if (static_cast<unsigned char>(c) < 0x20) result += std::format("\\u{:04x}", static_cast<int>(c));
+            else result += c;
+        }
+        return result;
+    }
+
+    std::string rate(const uint64_t num, const uint64_t den, const double scale, const bool valid) { // 不可用或分母为0时输出-
+        if (!valid || den == 0) return "-";
+        return std::format("{:.2f}", static_cast<double>(num) * scale / static_cast<double>(den));
+    }
+}
+
+namespace qrb::probe {
+    bool enable(const fs::path& trace, const bool pmu) {
+        if (!std::ofstream(trace).is_open()) return false;
+
+        trace_file = trace;
+        origin = std::chrono::steady_clock::now();
+        use_pmu = pmu;
+        active = true;
+
+        ZXing::QRCode::qr_zone = hook_zone;
+        ZXing::QRCode::qr_count = hook_count;
+        return true;
+    }
+
+    bool enabled() { return active; }
+
+    void count(const char* name, const int64_t value) {
+        if (!active) return;
+
+        auto& r = current();
+        r.counts[name] += value;
+        if (!r.open.empty()) r.open.back().counts[name] += value; // 归到最内层的区间，随区间结束一并写出
+    }
+
+    zone::zone(const char* name) {
+        if (!active) return;
+
+        begin(name, {});
+        open = true;
+    }
+
+    zone::zone(const char* name, const fs::path& file) {
+        if (!active) return;
+
+        begin(name, file.filename().string());
+        open = true;
+    }
+
+    zone::~zone() {
+        if (open) end();
+    }
+
+    void dump() {
+        if (!active) return;
+
+        const std::lock_guard guard(lock);
+
+        struct summary { // 同名区间跨线程汇总，嵌套区间的耗时与计数均包含子区间
+            uint64_t calls = 0;
+            int64_t total = 0;
+            int64_t max = 0;
+            pmu_t pmu{};
+        };
+        std::map<std::string, summary> stages;
+        std::map<std::pair<std::string, std::string>, int64_t> counters; // 计数器名称与所在区间 => 合计，不在区间内时区间为-
+        std::array<bool, num_pmu> valid{}; // 任一线程可用即输出该计数
+
+        for (const auto& r : logs) for (size_t k = 0; k < num_pmu; ++k) valid[k] = valid[k] || r->slot[k] >= 0;
+        constexpr std::array<const char*, num_pmu> pmu_key = {"cycles", "instructions", "l1d_misses", "llc_misses", "branches", "branch_misses"};
+
+        std::string json = R"({"displayTimeUnit": "ms", "traceEvents": [)";
+        bool first = true;
+        const auto append = [&](const std::string& line) {
+            json += (first ? "\n  " : ",\n  ") + line;
+            first = false;
+        };
+
+        for (const auto& r : logs) {
+            append(std::format(R"({{"name": "thread_name", "ph": "M", "pid": 1, "tid": {}, "args": {{"name": "thread {}"}}}})", r->tid, r->tid));
+            for (const auto& e : r->events) {
+                auto& s = stages[e.name];
+                ++s.calls;
+                s.total += e.dur;
+                s.max = std::max(s.max, e.dur);
+                for (size_t k = 0; k < num_pmu; ++k) s.pmu[k] += e.pmu[k];
+
+                std::string args;
+                if (!e.detail.empty()) args += std::format(R"("detail": "{}")", escape(e.detail));
+                for (size_t k = 0; k < num_pmu; ++k) if (r->slot[k] >= 0) args += std::format(R"({}"{}": {})", args.empty() ? "" : ", ", pmu_key[k], e.pmu[k]);
+                for (const auto& [name, value] : e.counts) args += std::format(R"({}"{}": {})", args.empty() ? "" : ", ", escape(name), value);
+
+                auto line = std::format(R"({{"name": "{}", "cat": "qrb", "ph": "X", "pid": 1, "tid": {}, "ts": {:.3f}, "dur": {:.3f})", e.name, r->tid, static_cast<double>(e.beg) / 1e3, static_cast<double>(e.dur) / 1e3);
+                if (!args.empty()) line += R"(, "args": {)" + args + "}";
+                append(line + "}");
+            }
+            counts_t running, outside = r->counts; // 计数器按线程分别成轨，每个区间结束时记一次累计值；事件按结束时刻排列
+            for (const auto& e : r->events) {
+                for (const auto& [name, value] : e.counts) {
+                    const auto track = logs.size() == 1 ? name : std::format("{} #{}", name, r->tid);
+                    append(std::format(R"({{"name": "{}", "ph": "C", "pid": 1, "tid": {}, "ts": {:.3f}, "args": {{"value": {}}}}})", escape(track), r->tid, static_cast<double>(e.beg + e.dur) / 1e3, running[name] += value));
+                    counters[{name, e.name}] += value;
+                    outside[name] -= value;
+                }
+            }
+            for (const auto& [name, value] : outside) if (value != 0) counters[{name, "-"}] += value;
+        }
+        json += "\n]}\n";
+
+        if (std::ofstream output(trace_file, std::ios::binary); output.is_open()) output.write(json.data(), static_cast<int64_t>(json.size()));
+
+        std::vector<std::pair<std::string, summary>> order(stages.begin(), stages.end());
+        std::ranges::sort(order, std::greater{}, [](const auto& p) { return p.second.total; });
+
+        std::cout << std::endl << std::format("{:<28}{:>10}{:>14}{:>12}{:>12}", "Stage", "Calls", "Total ms", "Mean ms", "Max ms") << std::endl;
+        for (const auto& [name, s] : order) {
+            std::cout << std::format("{:<28}{:>10}{:>14.3f}{:>12.3f}{:>12.3f}", name, s.calls, static_cast<double>(s.total) / 1e6,
+                                     static_cast<double>(s.total) / 1e6 / static_cast<double>(s.calls), static_cast<double>(s.max) / 1e6) << std::endl;
+        }
+
+        if (use_pmu && pmu_ok) { // 每千条指令的未命中数（MPKI）与分支预测失败率
+            std::cout << std::endl << std::format("{:<28}{:>14}{:>8}{:>12}{:>12}{:>14}", "Stage", "Mcycles", "IPC", "L1D MPKI", "LLC MPKI", "Branch miss%") << std::endl;
+            for (const auto& [name, s] : order) {
+                const auto& p = s.pmu;
+                std::cout << std::format("{:<28}{:>14.3f}{:>8}{:>12}{:>12}{:>14}", name, static_cast<double>(p[0]) / 1e6, rate(p[1], p[0], 1.0, valid[1]),
+                                         rate(p[2], p[1], 1e3, valid[1] && valid[2]), rate(p[3], p[1], 1e3, valid[1] && valid[3]), rate(p[5], p[4], 1e2, valid[4] && valid[5])) << std::endl;
+            }
+        } else if (use_pmu) std::cout << std::endl << "Counters: Unavailable (perf_event_open failed or unsupported)" << std::endl;
+
+        if (!counters.empty()) {
+            std::cout << std::endl << std::format("{:<28}{:<28}{:>10}", "Counter", "Stage", "Value") << std::endl;
+            for (const auto& [key, value] : counters) std::cout << std::format("{:<28}{:<28}{:>10}", key.first, key.second, value) << std::endl;
+        }
+        std::cout << std::endl << "Trace:   " << trace_file.string() << std::endl;
+
+        for (const auto& r : logs) r->release(); // 工作线程已结束，不再需要计数器
+        use_pmu = false;
+    }
+}
@@ -0,0 +1,166 @@
+#include <iostream>
+#include <fstream>
+#include <format>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <string_view>
+#include <algorithm>
+
+#ifdef WIN32
+#include <io.h>
+#include <cstdio>
+#else
+#include <unistd.h>
+#endif
+
+#include <qrb/progress.h>
+
+namespace {
+    using clock = std::chrono::steady_clock;
+
+    constexpr int64_t render_period = 100'000'000; // 终端重绘间隔，纳秒
+    constexpr int64_t event_period = 1'000'000'000; // 进度事件间隔，纳秒
+
+#ifdef WIN32
+    const bool tty = _isatty(_fileno(stdout)) != 0;
+#else
+    const bool tty = isatty(STDOUT_FILENO) != 0;
+#endif
+    const auto origin = clock::now(); // 事件时间的起点
+
+    std::atomic<bool> active = false; // 阶段进行中且有输出目标，否则更新只累加计数
+    std::atomic<uint64_t> done = 0, total = 0, found_n = 0;
+    std::atomic<double> fraction = 0.0;
+    std::atomic<int64_t> next_render = 0; // 下次重绘的时刻，相对阶段开始的纳秒数
+
+    std::mutex lock; // 串行化终端与事件输出，以及阶段的开始与结束
+    const char* stage = nullptr;
+    const char* unit = "";
+    clock::time_point beg;
+    int64_t next_event = 0;
+    size_t width = 0; // 终端上已绘制的最长进度行，重绘与清除时以空格覆盖
+    std::ofstream output;
+
+    int64_t elapsed() { return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - beg).count(); }
+
+    std::string amount(double value, const bool rate) { // 字节数按二进制前缀缩放
+        if (std::string_view(unit) == "bytes") {
+            const char* prefix = "B";
+            for (const char* p : {"KiB", "MiB", "GiB"}) {
+                if (value < 1024.0) break;
+                value /= 1024.0;
+                prefix = p;
+            }
+            return std::format("{:.1f} {}", value, prefix);
+        }
+        if (rate) return std::format("{:.1f} {}", value, unit);
+        return std::format("{:.0f} {}", value, unit);
+    }
+
+    std::string duration(const double s) { // 剩余时间，超过1小时时显示小时
+        if (!(s >= 0.0) || s > 359999.0) return "--:--";
+        const auto t = static_cast<int64_t>(s + 0.5);
+        if (t >= 3600) return std::format("{}:{:02}:{:02}", t / 3600, t / 60 % 60, t % 60);
+        return std::format("{:02}:{:02}", t / 60, t % 60);
+    }
+
+    void write(const char* type, const std::string& fields) { // 持有锁时调用
+        if (!output.is_open()) return;
+        const auto t = std::chrono::duration<double>(clock::now() - origin).count();
+        output << std::format(R"({{"t": {:.3f}, "event": "{}"{}{}}})", t, type, fields.empty() ? "" : ", ", fields) << '\n' << std::flush;
+    }
+
+    std::string state(const int64_t t) { // 当前阶段的进度事件成员
+        const auto s = static_cast<double>(t) / 1e9;
+        const auto n = total.load(std::memory_order_relaxed), d = done.load(std::memory_order_relaxed);
+        const auto rate = s > 0.0 ? (static_cast<double>(d) + fraction.load(std::memory_order_relaxed)) / s : 0.0;
+        return std::format(R"("stage": "{}", "unit": "{}", "done": {}, "total": {}, "elapsed": {:.3f}, "rate": {:.3f}, "eta": {}, "found": {})",
+                           stage, unit, d, n == 0 ? "null" : std::to_string(n), s, rate,
+                           n == 0 || rate <= 0.0 ? "null" : std::format("{:.1f}", static_cast<double>(n - std::min(n, d)) / rate), found_n.load(std::memory_order_relaxed));
+    }
+
+    void render(const int64_t t) { // 持有锁时调用
+        const auto s = static_cast<double>(t) / 1e9;
+        const auto n = static_cast<double>(total.load(std::memory_order_relaxed));
+        const auto d = static_cast<double>(done.load(std::memory_order_relaxed)) + fraction.load(std::memory_order_relaxed);
+        const auto rate = s > 0.0 ? d / s : 0.0;
+
+        auto line = n == 0.0 ? std::format(" {} [{}] [{}/s]", amount(d, false), stage, amount(rate, true))
+                             : std::format(" {:>4.1f}% [{}] [{}/s, ETA {}]", std::min(99.9, 100.0 * d / n), stage, amount(rate, true),
+                                           duration(rate > 0.0 ? (n - d) / rate : -1.0));
+        width = std::max(width, line.size());
+        line.resize(width, ' ');
+        std::cout << "\r" << line << std::flush;
+    }
+
+    void tick() { // 到达间隔时由恰好一个线程输出
+        if (!active.load(std::memory_order_acquire)) return;
+        const auto t = elapsed();
+        auto due = next_render.load(std::memory_order_relaxed);
+        if (t < due || !next_render.compare_exchange_strong(due, t + render_period, std::memory_order_relaxed)) return;
+
+        const std::lock_guard guard(lock);
+        if (stage == nullptr) return;
+        if (tty) render(t);
+        if (output.is_open() && t >= next_event) {
+            next_event = t + event_period;
+            write("progress", state(t));
+        }
+    }
+}
+
+namespace qrb::progress {
+    bool events(const fs::path& file) {
+        const std::lock_guard guard(lock);
+        output.open(file, std::ios::binary | std::ios::trunc);
+        return output.is_open();
+    }
+
+    void start(const char* stage_name, const uint64_t total_n, const char* unit_name) {
+        const std::lock_guard guard(lock);
+        stage = stage_name;
+        unit = unit_name;
+        beg = clock::now();
+        next_event = 0;
+        width = 0;
+        done = 0;
+        total = total_n;
+        fraction = 0.0;
+        next_render = 0;
+        active.store(tty || output.is_open(), std::memory_order_release);
+        write("start", std::format(R"("stage": "{}", "unit": "{}", "total": {})", stage, unit, total_n == 0 ? "null" : std::to_string(total_n)));
+    }
+
+    void advance(const uint64_t n) {
+        done.fetch_add(n, std::memory_order_relaxed);
+        fraction.store(0.0, std::memory_order_relaxed);
+        tick();
+    }
+
+    void set(const uint64_t n) {
+        done.store(n, std::memory_order_relaxed);
+        tick();
+    }
+
+    void part(const double f) {
+        fraction.store(std::clamp(f, 0.0, 1.0), std::memory_order_relaxed);
+        tick();
+    }
+
+    void found(const uint64_t n) { found_n.store(n, std::memory_order_relaxed); }
+
+    void finish() {
+        const std::lock_guard guard(lock);
+        if (stage == nullptr) return;
+        active.store(false, std::memory_order_release);
+        if (tty && width != 0) std::cout << "\r" << std::string(width, ' ') << "\r" << std::flush;
+        write("finish", state(elapsed()));
+        stage = nullptr;
+    }
+
+    void emit(const char* type, const std::string& fields) {
+        const std::lock_guard guard(lock);
+        write(type, fields);
+    }
+}
@@ -1,17 +1,26 @@
+#include <cstring>
+#include <algorithm>
+
 #include <opencv2/imgproc.hpp>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
 #include <QRReader.h>
 #include <QRWriter.h>
 #include <QRCodecMode.h>
 #include <QRVersion.h>
 #include <BitMatrix.h>
+#include <QRDecoder.h>
 #include <GlobalHistogramBinarizer.h>
 
 #include <qrb/qr.h>
 
 namespace {
-    constexpr int scale = 4;  // 图像缩放4倍
-    constexpr int margin = 2; // 留白2模块
+    constexpr int margin = 2; // 留白2模块，解码时按此推算网格，故固定不变
+
+    int scale = 4; // 图像缩放倍数，即每模块的像素边长
 
     bool update = true;
 
@@ -20,13 +29,38 @@ namespace {
     int qr_sp = 0;
     float qr_ratio = 0.0f;
 
+    std::vector<uint8_t> scanline; // 展开后的单行像素，左右留白始终为白色
+    std::vector<cv::Point> corners; // 识别结果四角的像素坐标，各次识别间复用
+
     auto encoder = ZXing::QRCode::Writer{};
-    auto decoder = ZXing::QRCode::Reader(ZXing::ReaderOptions{}, false);
+    auto options = ZXing::ReaderOptions{}; // 解码器只保存引用，须与其同生命周期
+    auto decoder = ZXing::QRCode::Reader(options, false);
+    auto grid = ZXing::BitMatrix(); // 格点采样的模块矩阵，尺寸不变时复用
+
+    void expand(const uint8_t* modules, const int count, uint8_t* line) { // 将一行模块按缩放倍数展开为像素，黑色模块为0xFF
+        int x = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+        if (scale == 4) { // 每次取反并复制16个模块为64个像素
+            for (; x + 16 <= count; x += 16) {
+                const __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(modules + x)), _mm_set1_epi8(-1));
+                const __m128i lo = _mm_unpacklo_epi8(v, v);
+                const __m128i hi = _mm_unpackhi_epi8(v, v);
+                const auto out = reinterpret_cast<__m128i*>(line + x * scale);
+                _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(lo, lo));
+                _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo, lo));
+                _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi, hi));
+                _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi, hi));
+            }
+        }
+#endif
+        for (; x < count; ++x) std::memset(line + x * scale, static_cast<uint8_t>(~modules[x]), scale);
+    }
 }
 
 namespace qrb::qr {
-    void config(const int qr_version, const int qr_ecc) {
+    void config(const int qr_version, const int qr_ecc, const int qr_unit) {
         update = true;
+        scale = qr_unit;
 
         const auto v = ZXing::QRCode::Version::Model2(qr_version);
         const auto e = static_cast<ZXing::QRCode::ErrorCorrectionLevel>(qr_ecc);
@@ -39,6 +73,8 @@ namespace qrb::qr {
         encoder.setVersion(qr_version);
         encoder.setMargin(margin);
         encoder.setErrorCorrectionLevel(e);
+
+        scanline.assign(qr_px, 255);
     }
 
     void fresh() {
@@ -48,31 +84,49 @@ namespace qrb::qr {
         ZXing::QRCode::qr_ecc.reset();
     }
 
+    void strategy(const bool try_harder) { options.setTryHarder(try_harder); }
+
+    void hint(const int unit_px) { options.setModuleSize(static_cast<uint8_t>(std::clamp(unit_px, 0, 255))); }
+
     int px() { return qr_px; }
     int sp() { return qr_sp; }
+    int unit() { return scale; }
+    int border() { return margin * scale; }
     float ratio() { return qr_ratio; }
     int cap() { return qr_cap; }
 
     void encode(const std::span<const uint8_t> data, cv::Mat& img) {
-        ZXing::BitArray block;
-        for (const auto& byte : data) block.appendBits(byte, 8);
-        const ZXing::BitMatrix qr = encoder.encode(block, qr_px, qr_px);
-        for (int y = 0; y < qr.height(); ++y)
-            for (int x = 0; x < qr.width(); ++x)
-                if (qr.get(x, y)) img.at<uint8_t>(y, x) = 0; else img.at<uint8_t>(y, x) = 255; // 两种情况都要写入，否则可能会残留上一页的缓冲
+        const ZXing::BitMatrix qr = encoder.encode(data); // 按字节直接写入码字，无需逐位拼接；仅生成模块矩阵，不放大
+        const int quiet = margin * scale;
+
+        // 所有像素都要写入，否则可能会残留上一页的缓冲
+        img.rowRange(0, quiet).setTo(255);
+        img.rowRange(qr_px - quiet, qr_px).setTo(255);
+        for (int y = 0; y < qr.height(); ++y) { // 每行模块只展开一次，再整行复制缩放倍数次
+            expand(qr.row(y).begin(), qr.width(), scanline.data() + quiet);
+            for (int i = 0; i < scale; ++i) std::memcpy(img.ptr<uint8_t>(quiet + y * scale + i), scanline.data(), qr_px);
+        }
+    }
+
+    void matrix(const std::span<const uint8_t> data, cv::Mat& modules) {
+        const ZXing::BitMatrix qr = encoder.encode(data);
+
+        modules.create(qr.height(), qr.width(), CV_8UC1); // 尺寸不变时复用已有内存
+        for (int y = 0; y < qr.height(); ++y) std::memcpy(modules.ptr<uint8_t>(y), qr.row(y).begin(), qr.width());
     }
 
     std::pair<std::vector<std::vector<uint8_t>>, std::vector<cv::Rect>> decode(const cv::Mat& img, const bool single) {
         try {
             // 必须为单通道灰度图
             const auto iv = ZXing::ImageView(img.data, img.cols, img.rows, ZXing::ImageFormat::Lum, static_cast<int>(img.step[0]), 1);
-            const auto [data, quad] = decoder.decode(ZXing::GlobalHistogramBinarizer(iv), single);
+            auto [data, quad] = decoder.decode(ZXing::GlobalHistogramBinarizer(iv), single); // 检测与纠错的临时缓冲由解码器按线程复用
 
             std::vector<cv::Rect> box;
+            box.reserve(quad.size());
             for (const auto& q : quad) {
-                std::vector<cv::Point> b;
-                for (const auto& p : q) b.emplace_back(p.x, p.y);
-                if (!b.empty()) box.push_back(cv::boundingRect(b));
+                corners.clear();
+                for (const auto& p : q) corners.emplace_back(p.x, p.y);
+                if (!corners.empty()) box.push_back(cv::boundingRect(corners));
             }
 
             if (!box.empty() && !data.empty()) {
@@ -81,10 +135,28 @@ namespace qrb::qr {
                     update = false;
                 }
                 
-                return {data, box};
+                return {std::move(data), std::move(box)};
             }
         } catch (...) { return {}; }
 
         return {};
     }
+
+    std::vector<uint8_t> sample(const cv::Mat& img, const cv::Point origin, const int dim, const int unit, const bool adopt) {
+        if (unit < 1 || origin.x < 0 || origin.y < 0 || origin.x + dim * unit > img.cols || origin.y + dim * unit > img.rows) return {};
+        try {
+            if (grid.width() != dim) grid = ZXing::BitMatrix(dim);
+            for (int y = 0; y < dim; ++y) {
+                const auto* p = img.ptr<uint8_t>(origin.y + y * unit + unit / 2) + origin.x + unit / 2;
+                for (int x = 0; x < dim; ++x) grid.set(x, y, p[x * unit] < 128);
+            }
+
+            auto data = ZXing::QRCode::Decode(grid);
+            if (adopt && update && !data.empty() && ZXing::QRCode::qr_version.has_value() && ZXing::QRCode::qr_ecc.has_value()) {
+                config(ZXing::QRCode::qr_version.value(), ZXing::QRCode::qr_ecc.value());
+                update = false;
+            }
+            return data;
+        } catch (...) { return {}; }
+    }
 }
\ No newline at end of file
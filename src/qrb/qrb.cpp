@@ -1,56 +1,656 @@
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <chrono>
+#include <functional>
 #include <ranges>
 #include <valarray>
+#include <cctype>
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <tuple>
 
 #include <qrb/qr.h>
 #include <qrb/page.h>
 #include <qrb/index.h>
 #include <qrb/file.h>
+#include <qrb/fountain.h>
+#include <qrb/rs.h>
+#include <qrb/slot.h>
+#include <qrb/archive.h>
+#include <qrb/probe.h>
+#include <qrb/progress.h>
 #include <qrb/qrb.h>
 
 namespace {
     std::error_code err;
+
+    std::string page_ext = ".png"; // 编码输出的页图像扩展名
+    int repair_ratio = -1;         // 喷泉码修复符号数量占源块数量的百分比，负数表示不使用喷泉码
+    int rs_k = 0;                  // 跨页纠删码每组的数据符号数，0表示不使用纠删码
+    int rs_m = 0;                  // 跨页纠删码每组的校验符号数
+    bool use_zip = true;           // 编码前压缩文件数据，无收益时自动使用存储模式
+    int layout = 1;                // 文件块格式版本，1为变长序号，2为按页定位的块头部
+    bool use_colour = false;       // 三通道彩色页，每页容量为黑白页的三倍
+    bool use_delta = false;        // 增量编码，只重新生成内容变化的页，此时总使用存储模式
+    bool use_verify = false;       // 写页后在内存中解码校验
+    std::vector<std::string> only; // 解码时只恢复归档中的这些成员，为空表示完整解码
+    fs::path out_dir;              // 解码输出目录
+    std::vector<std::vector<uint8_t>> pending;       // v1格式序号小于128的块与v2紧凑块的首字节相同，确定格式前暂存；v2中暂无法定位的紧凑块待读到尾块后再定位
+    bool plain = false;                              // 解码时已确定为v1格式
+
+    int unit = 4;         // 每模块的像素边长
+    int area_w = 0;       // 自动布局时页面可用区域的像素宽，0表示不使用自动布局
+    int area_h = 0;       // 自动布局时页面可用区域的像素高
+    int min_unit = 0;     // 自动布局时每模块的最小像素边长
+    constexpr int print_margin = 10;                   // 纸张四周预留的打印边距，单位毫米
+    constexpr int64_t max_modules = 6 * 9 * 93 * 93;   // 每页模块总数上限，以A4纸版本19每页6列9行为参照，过密时识别困难
+    double cost_px = 15.0;     // 每页像素的解码耗时，纳秒，主要为预处理与网格识别；默认值为粗略估计，可由qrb_bench拟合后以costs载入
+    double cost_module = 40.0; // 每个模块的解码耗时，纳秒，主要为二值化、定位与纠错；自动布局只比较页数相同的候选，仅两者之比影响选择
+
+    void report() { // 输出打包后改变大小的成员与写页后校验的结果
+        for (const auto& f : qrb::archive::changed()) std::cout << "Error: " << f.string() << " changed size while encoding, its restored copy will be wrong" << std::endl;
+        if (!use_verify) return;
+        const auto [count, failed] = qrb::file::verified();
+        std::cout << "Verified: " << count - failed.size() << " / " << count << std::endl;
+
+        std::string pages;
+        for (const auto& f : failed) {
+            std::cout << "Unreadable: " << f.generic_string() << std::endl;
+            pages += std::format(R"({}"{}")", pages.empty() ? "" : ", ", f.generic_string());
+        }
+        qrb::progress::emit("verify", std::format(R"("pages": {}, "unreadable": [{}])", count, pages));
+    }
+
+    void refuse() { // 输出分带识别拒绝的彩色页
+        if (const auto n = qrb::page::rejected(); n != 0) std::cout << "Error: --band does not recognize colour pages, skipped " << n << " image(s); decode them without --band" << std::endl;
+    }
+
+    uint32_t repair(const uint32_t k) { return static_cast<uint32_t>((static_cast<uint64_t>(k) * repair_ratio + 99) / 100); }
+
+    void write_fountain() { // 读入全部源数据，按种子顺序生成系统符号与修复符号并分页
+        const auto k = qrb::fountain::count();
+        const auto n = k + repair(k);
+
+        std::vector<uint8_t> source(qrb::file::total());
+        qrb::file::read(source, 0, source.size());
+
+        std::vector<uint8_t> buffer(static_cast<size_t>(qrb::qr::cap()) * qrb::page::cap());
+        size_t offset = 0;
+
+        qrb::progress::start("Encode", n, "symbols");
+        for (uint32_t seed = 0; seed < n; ++seed) {
+            qrb::fountain::encode(seed, source, std::span{buffer}.subspan(offset, qrb::qr::cap()));
+            offset += qrb::qr::cap();
+
+            if (offset == buffer.size() || seed + 1 == n) { // 换页
+                qrb::file::write(std::span{buffer}.first(offset), std::to_string(seed / qrb::page::cap() + 1) + page_ext, false);
+                offset = 0;
+            }
+
+            qrb::progress::advance();
+        }
+        qrb::progress::finish();
+
+        std::cout << "Blocks: " << k << " + " << n - k << "(Fountain)" << std::endl;
+        report();
+    }
+
+    void write_erasure(const std::vector<uint8_t>& source) { // 按行优先输出各组校验块，丢失一页校验块时每组至多缺失一行
+        const auto cap = static_cast<size_t>(qrb::qr::cap());
+        const auto s_cnt = qrb::rs::stripes(), m = qrb::rs::parity();
+
+        std::vector<uint8_t> parity(static_cast<size_t>(s_cnt) * m * cap);
+        qrb::progress::start("Parity", s_cnt, "stripes");
+        for (uint32_t s = 0; s < s_cnt; ++s) {
+            qrb::rs::encode(s, source, std::span{parity}.subspan(static_cast<size_t>(s) * m * cap, m * cap));
+            qrb::progress::advance();
+        }
+        qrb::progress::finish();
+
+        std::vector<uint8_t> buffer(cap * qrb::page::cap());
+        size_t offset = 0, count = 0;
+        for (uint32_t j = 0; j < m; ++j) {
+            for (uint32_t s = 0; s < s_cnt; ++s, ++count) {
+                std::copy_n(parity.begin() + static_cast<int64_t>((static_cast<size_t>(s) * m + j) * cap), cap, buffer.begin() + static_cast<int64_t>(offset));
+                offset += cap;
+                if (offset == buffer.size() || count + 1 == static_cast<size_t>(s_cnt) * m) { // 换页
+                    qrb::file::write(std::span{buffer}.first(offset), std::to_string(count / qrb::page::cap() + 1) + page_ext, true);
+                    offset = 0;
+                }
+            }
+        }
+    }
+
+    void accept(const std::vector<uint8_t>& block, const uint32_t slot_index, const bool is_ecc, std::array<std::unordered_map<uint32_t, bool>, 2>& index, std::optional<uint32_t>& last_index) { // 按格式分派一个块并写入对应位置，slot_index为v2格式解析出的序号
+        if (qrb::fountain::check(block)) { qrb::fountain::insert(block); return; }
+        if (is_ecc && qrb::rs::check(block)) { qrb::rs::insert(block); return; }
+        if (!is_ecc && qrb::slot::active()) { // v2格式文件块
+            const auto idx = slot_index;
+            if (idx == 0) { // 同一图像中没有对应的定位块时，紧凑块暂存至读到尾块
+                if (!qrb::slot::check(block) && !block.empty() && block[0] >= 1 && block[0] < 0x80) pending.push_back(block);
+                return;
+            }
+            if (index[0].contains(idx)) return;
+            if (block.size() != qrb::qr::cap()) { // 仅尾块可不足整块，尾块总是定位块
+                if (!qrb::slot::check(block) || (last_index.has_value() && last_index != idx)) return;
+                last_index = idx;
+                qrb::slot::last(idx);
+            }
+            if (qrb::slot::check(block) != (qrb::slot::len(idx) == qrb::slot::len())) return; // 块类型与所在位置不符
+            qrb::file::write(block, qrb::slot::len(idx), idx, false);
+            index[0][idx] = true;
+            return;
+        }
+        if (!is_ecc && !plain) { // 格式未定
+            if (!block.empty() && block[0] >= 1 && block[0] < 0x80) { pending.push_back(block); return; }
+            plain = true; // 首字节为尾块标记或多字节序号，确定为v1格式
+            for (const auto& b : std::exchange(pending, {})) accept(b, 0, false, index, last_index);
+        }
+
+        auto [idx, len] = qrb::index::decode(block, is_ecc);
+
+        if (len == 0 || (!is_ecc && last_index.has_value() && idx > last_index)) return; // 序号合法性检查
+        if (index[is_ecc].contains(idx)) return; // 去重
+        if (block.size() == len || ((is_ecc || idx != 0) && block.size() != qrb::qr::cap())) return; // 块长度合法性检查
+
+        uint32_t offset = len;
+
+        if (idx == 0 && !last_index.has_value() && !is_ecc) { // 文件块尾块
+            std::tie(idx, len) = qrb::index::decode(std::span{block}.subspan(offset), false);
+            if (len == 0 || index[0].contains(idx) || idx == 0) return; // 尾块序号合法性检查
+            last_index = idx;
+            offset += len;
+        }
+
+        qrb::file::write(block, offset, idx, is_ecc);
+        index[is_ecc][idx] = true;
+    }
+
+    void accept(const std::vector<std::vector<uint8_t>>& blocks, const bool is_ecc, std::array<std::unordered_map<uint32_t, bool>, 2>& index, std::optional<uint32_t>& last_index) { // 分派一页的全部块，v2紧凑块的页号由同一图像中的定位块给出
+        const auto slots = is_ecc ? std::vector<uint32_t>(blocks.size(), 0) : qrb::slot::decode(blocks);
+        const bool known = qrb::slot::count() != 0;
+        for (size_t i = 0; i < blocks.size(); ++i) accept(blocks[i], slots[i], is_ecc, index, last_index);
+        if (known || qrb::slot::count() == 0) return;
+
+        for (const auto& b : std::exchange(pending, {})) accept(b, qrb::slot::decode({b})[0], false, index, last_index); // 刚读到尾块，总页数已知，暂存的紧凑块再次定位，仍无法定位的重新暂存
+    }
+
+    void settle(std::array<std::unordered_map<uint32_t, bool>, 2>& index, std::optional<uint32_t>& last_index) { // 读完仍未确定格式时，暂存的块按v1格式写入
+        if (qrb::slot::active() || plain) return;
+        plain = true;
+        for (const auto& b : std::exchange(pending, {})) accept(b, 0, false, index, last_index);
+    }
+
+    void read_only() { // 由数据流开头的目录定位所选成员所在的页，只解码这些页
+        std::array<std::unordered_map<uint32_t, bool>, 2> index{};
+        std::optional<uint32_t> last_index;
+        std::vector<bool> done(qrb::file::total(), false);
+        uint64_t decoded = 0;
+
+        const auto decode = [&](const uint64_t i) {
+            if (i >= done.size() || done[i]) return;
+            done[i] = true;
+            ++decoded;
+
+            const auto [data, is_ecc] = qrb::file::read(i);
+            accept(data, is_ecc, index, last_index);
+            qrb::progress::found(index[0].size());
+            qrb::progress::advance();
+        };
+
+        const auto complete = [&](const uint64_t beg, const uint64_t end) { // 区间内的文件块是否均已接收
+            if (qrb::qr::cap() == 0) return false;
+            for (auto i = qrb::file::locate(beg); qrb::file::offset(i) < end && last_index.value_or(i) >= i; ++i) if (!index[0].contains(i)) return false;
+            return true;
+        };
+
+        uint32_t page_cap = 0; // v1格式以第1页的最大块序号估计每页二维码个数
+        const auto fetch = [&](const uint64_t beg, const uint64_t end) {
+            if (complete(beg, end)) return true;
+            if (const auto cap = qrb::slot::cap() != 0 ? qrb::slot::cap() : page_cap; cap != 0 && qrb::qr::cap() != 0) { // 先解码预计包含该区间的页
+                for (auto p = (qrb::file::locate(beg) - 1) / cap; p <= (qrb::file::locate(end - 1) - 1) / cap; ++p) decode(qrb::file::find(p + 1));
+                if (complete(beg, end)) return true;
+            }
+            for (uint64_t i = 0; i < done.size(); ++i) { // 估计有误或图像未按页号命名时依次解码其余图像
+                decode(i);
+                if (complete(beg, end)) return true;
+            }
+            settle(index, last_index);
+            return complete(beg, end);
+        };
+
+        qrb::progress::start("Decode", 0, "images"); // 只解码部分图像，总量未知
+        decode(qrb::file::find(1));
+        for (const auto i : index[0] | std::views::keys) page_cap = std::max(page_cap, i);
+        for (const auto& b : pending) page_cap = std::max<uint32_t>(page_cap, b[0]); // 格式未定时暂存的块
+
+        std::string root;
+        std::vector<qrb::archive::entry> items;
+        if (fetch(0, 14)) if (const auto len = qrb::archive::size(qrb::file::load(0, 14)); len != 0 && fetch(0, len)) std::tie(root, items) = qrb::archive::list(qrb::file::load(0, len));
+
+        qrb::progress::finish();
+        refuse();
+        if (items.empty()) {
+            std::cout << "Missing: Directory" << std::endl;
+            qrb::file::discard();
+            return;
+        }
+
+        const auto dir = out_dir / fs::path(std::u8string(root.begin(), root.end())); // 与完整解码相同，解包到以归档根名称命名的目录
+        for (const auto& name : only) {
+            bool found = false;
+            for (const auto& item : items) {
+                if (!qrb::archive::match(item, name)) continue;
+                found = true;
+
+                const bool ok = fetch(item.offset, item.offset + item.length) &&
+                                qrb::archive::extract(item, qrb::file::load(item.offset, item.length), dir);
+                std::cout << (ok ? "File:    " : "Missing: ") << item.name << std::endl;
+            }
+            if (!found) std::cout << "Missing: " << name << std::endl;
+        }
+
+        std::cout << "Pages:   " << decoded << " / " << done.size() << std::endl;
+        qrb::file::discard();
+    }
+
+    bool arrange() { // 依赖file统计的总字节数的配置
+        qrb::slot::clean();
+        if (layout == 2 && qrb::page::cap() > static_cast<int>(qrb::slot::max_cap)) {
+            std::cout << "Error: --container 2 allows at most " << qrb::slot::max_cap << " QR codes per page, got " << qrb::page::cap() << std::endl;
+            return false;
+        }
+        if (layout == 2 && !qrb::slot::config(qrb::file::total(), qrb::qr::cap(), qrb::page::cap())) return false;
+        if (const auto limit = rs_k > 0 ? qrb::rs::max_total : qrb::fountain::max_total; (rs_k > 0 || repair_ratio >= 0) && qrb::file::total() > limit) { // 两者编码时都整体读入源数据
+            std::cout << "Error: " << (rs_k > 0 ? "--rs" : "--fountain") << " accepts at most " << (limit >> 20) << " MiB of input data, got " << qrb::file::total() << " bytes" << std::endl;
+            return false;
+        }
+        if (rs_k > 0) return qrb::rs::config(qrb::file::total(), qrb::qr::cap(), rs_k, rs_m);
+        if (repair_ratio < 0) return true;
+
+        const auto k = qrb::fountain::config(qrb::file::total(), qrb::qr::cap());
+        return k != 0 && static_cast<uint64_t>(k) + repair(k) <= qrb::fountain::max();
+    }
+
+    std::string render_key(const int num_col, const int num_row, const int qr_version, const int qr_ecc) { // 增量编码时决定页面图像的参数，任一变化则全部重新生成
+        if (!use_delta) return {};
+        return std::format("{}x{} {}-{} {}px{} {}", num_col, num_row, qr_version, qr_ecc, unit, use_colour ? " colour" : "", page_ext);
+    }
+
+    std::pair<uint64_t, uint64_t> blocks(const uint64_t total, const uint32_t cap, const uint64_t per_page, const int file_ecc) { // 估计文件块数与单独成页的冗余块数
+        const auto head = layout == 2 ? qrb::slot::len() : qrb::index::len(static_cast<uint32_t>(std::min<uint64_t>(total / cap + 1, qrb::index::max())));
+        if (cap <= head + 12 || (layout == 2 && per_page > qrb::slot::max_cap)) return {};
+
+        const auto page_head = qrb::slot::overhead(static_cast<uint32_t>(per_page)); // v2每页首末为定位块，其余为紧凑块
+        const auto n = layout == 2 ? total * per_page / (cap * per_page - page_head) + 1 : total / (cap - head) + 1;
+        if (layout == 1 && n > qrb::index::max()) return {}; // 超出文件块序号的表示范围
+        if (rs_k > 0) return {n, ((total + cap - 13) / (cap - 12) + rs_k - 1) / rs_k * rs_m};
+        if (repair_ratio >= 0) return {n + repair(static_cast<uint32_t>(n)), 0}; // 修复符号与源块连续分页
+        if (file_ecc > 0) return {n, (n + (1ULL << file_ecc) - 1) / (1ULL << file_ecc)};
+        return {n, 0};
+    }
+
+    void write_slot() { // v2格式每页首末块以定位块头部开始，其余以紧凑块头部开始，块在数据流中的位置由序号直接确定
+        const auto n = qrb::slot::count();
+        const bool use_rs = qrb::rs::total() != 0;
+
+        std::vector<uint8_t> buffer(static_cast<size_t>(qrb::qr::cap()) * qrb::page::cap()), source;
+        size_t offset = 0;
+
+        qrb::progress::start("Encode", n, "blocks");
+        for (uint32_t i = 1; i <= n; ++i) {
+            const auto head = qrb::slot::len(i);
+            qrb::slot::encode(i, std::span{buffer}.subspan(offset));
+            const auto count = qrb::file::read(buffer, offset + head, qrb::qr::cap() - head);
+            if (use_rs) source.insert(source.end(), buffer.begin() + static_cast<int64_t>(offset + head), buffer.begin() + static_cast<int64_t>(offset + head + count));
+            offset += head + count;
+
+            if (i % qrb::page::cap() == 0 || i == n) { // 换页
+                qrb::file::write(std::span{buffer}.first(offset), std::to_string((i + qrb::page::cap() - 1) / qrb::page::cap()) + page_ext, false);
+                offset = 0;
+            }
+
+            qrb::progress::advance();
+        }
+        qrb::progress::finish();
+
+        if (use_rs) write_erasure(source);
+
+        std::cout << "Blocks: " << n;
+        if (use_rs) std::cout << " + " << qrb::rs::stripes() * qrb::rs::parity() << "(RS)";
+        std::cout << std::endl;
+        report();
+    }
+
+    struct score { // 图像集的识别结果
+        size_t symbols = 0; // 各图像中不重复的二维码个数之和
+        double seconds = 0.0;
+        double rate() const { return seconds > 0.0 ? static_cast<double>(symbols) / seconds : 0.0; }
+    };
+
+    score evaluate(const std::vector<fs::path>& images) { // 以当前解码参数识别全部图像，屏蔽逐页进度输出
+        std::ostringstream sink;
+        auto* const old = std::cout.rdbuf(sink.rdbuf());
+
+        score s;
+        const auto beg = std::chrono::steady_clock::now();
+        for (const auto& img : images) {
+            qrb::qr::fresh(); // 图像集可能混有不同版本的二维码
+            auto data = qrb::page::read(img);
+            std::ranges::sort(data);
+            s.symbols += static_cast<size_t>(std::ranges::distance(data.begin(), std::ranges::unique(data).begin()));
+        }
+        s.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - beg).count();
+
+        std::cout.rdbuf(old);
+        return s;
+    }
+
+    bool better(const score& a, const score& b) { // 识别个数优先，个数相同时速度须快2%以上，避免计时波动导致反复切换
+        if (a.symbols != b.symbols) return a.symbols > b.symbols;
+        return a.rate() > b.rate() * 1.02;
+    }
+
+    std::string dump_params(const qrb::page::params& p) { // 解码参数文件，每行为名称与取值
+        return std::format("tolerance {}\nroi_scale {}\nroi_tries {}\npasses {}\nfilter_d {}\nfilter_sigma {}\nbinarizer {}\ntry_harder {}\n",
+                           p.tolerance, p.roi_scale, p.roi_tries, p.passes, p.filter_d, p.filter_sigma, p.binarizer, p.try_harder ? 1 : 0);
+    }
 }
 
 namespace qrb {
     bool config(const fs::path& input_file, const fs::path& output_dir, const int num_col, const int num_row, const int qr_version, const int qr_ecc, const int file_ecc) {
         if (num_col < 1 || num_row < 1 || qr_version < 1 || qr_version > 40 || qr_ecc < 0 || qr_ecc > 3 || file_ecc < 0 || file_ecc > 6) return false;
-        if (!fs::exists(input_file, err) || err || !fs::is_regular_file(input_file, err) || err) return false;
-
-        qr::config(qr_version, qr_ecc);
-        page::config(num_col, num_row); // page依赖qr，需先配置qr
+        if ((repair_ratio >= 0) + (rs_k > 0) + (file_ecc != 0) > 1) return false; // 喷泉码、纠删码与奇偶校验互斥
+        if (layout == 2 && (repair_ratio >= 0 || file_ecc != 0)) return false;    // v2格式不支持喷泉码与奇偶校验
+        if (input_file == "-") { // 标准输入的总字节数直到读完才确定，不支持依赖总字节数的格式
+            if (repair_ratio >= 0 || rs_k > 0 || layout == 2) return false;
+        } else if (!fs::exists(input_file, err) || err || !(fs::is_regular_file(input_file, err) || fs::is_directory(input_file, err)) || err) return false;
+
+        qr::config(qr_version, qr_ecc, unit);
+        page::config(num_col, num_row, use_colour); // page依赖qr，需先配置qr
         index::config(file_ecc);
 
-        if (page::cap() > index::max()) return false;
+        if (page::cap() > index::max() || !page::writable(page_ext)) return false; // 彩色页不能使用1位与矢量格式
+        if (use_delta && page_ext == ".pdf") return false; // PDF为多页文档，无法单独替换其中的页
+
+        file::incremental(render_key(num_col, num_row, qr_version, qr_ecc));
+        file::verify(use_verify);
+        if (!file::config(input_file, output_dir, use_zip && !use_delta)) return false; // file依赖qr、index和page，需最后配置；压缩数据前部的改动会使其后每页都变化，增量编码时不压缩
+        return arrange(); // v2格式、纠删码与喷泉码依赖file统计的总字节数
+    }
+
+    bool paper(const std::string& size, const int dpi, const int module_px) {
+        static const std::unordered_map<std::string, std::pair<int, int>> known = {
+            {"a3", {297, 420}}, {"a4", {210, 297}}, {"a5", {148, 210}}, {"letter", {216, 279}}, {"legal", {216, 356}}
+        };
+
+        auto key = size;
+        std::ranges::transform(key, key.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+        int w = 0, h = 0;
+        if (const auto it = known.find(key); it != known.end()) std::tie(w, h) = it->second;
+        else if (const auto x = key.find('x'); x != std::string::npos) { // 宽x高，单位毫米
+            try { w = std::stoi(key.substr(0, x)); h = std::stoi(key.substr(x + 1)); } catch (...) { return false; }
+        }
+        if (w <= 2 * print_margin || h <= 2 * print_margin || dpi < 72 || dpi > 4800 || module_px < 1 || module_px > 32) return false;
+
+        area_w = static_cast<int>((w - 2 * print_margin) * dpi / 25.4);
+        area_h = static_cast<int>((h - 2 * print_margin) * dpi / 25.4);
+        min_unit = module_px;
+        return true;
+    }
+
+    bool plan(const fs::path& input_file, const fs::path& output_dir, const int file_ecc) {
+        if (area_w == 0 || input_file == "-") return false; // 布局依赖总字节数
+
+        unit = min_unit; // 模块越小每页容纳越多，缩放倍数取允许的最小值
+        if (!config(input_file, output_dir, 1, 1, 40, 0, file_ecc)) return false; // 先以最大容量配置，得到压缩或打包后的总字节数
+        const auto total = file::total();
+
+        struct candidate { int col = 0, row = 0, version = 0, ecc = 0; uint64_t pages = 0; double cost = 0.0; };
+        candidate best;
+
+        for (int v = 1; v <= 40; ++v) {
+            const int n = 4 * v + 17;
+            qr::config(v, 0, unit);
+            const int cell = qr::px() + qr::sp();
+            const int grid_h = use_colour ? area_h - 2 * qr::border() - area_w / 16 : area_h; // 彩色页底部预留校准色块
+            int col = (area_w - qr::sp()) / cell, row = (grid_h - qr::sp()) / cell;
+            if (col < 1 || row < 1) break; // 版本越大单个二维码越大，之后均无法放入
+
+            if (static_cast<int64_t>(col) * row * n * n > max_modules) { // 超出单页识别能力时减少行数，仍超出则减少列数
+                row = static_cast<int>(std::max<int64_t>(1, max_modules / (static_cast<int64_t>(col) * n * n)));
+                if (static_cast<int64_t>(col) * row * n * n > max_modules) col = static_cast<int>(std::max<int64_t>(1, max_modules / (static_cast<int64_t>(n) * n)));
+            }
+            const auto per_page = static_cast<uint64_t>(col) * row * (use_colour ? 3 : 1);
+
+            candidate c{col, row, v, 0};
+            for (int e = 0; e <= 3; ++e) { // 页数不变时选择最高的纠错等级
+                qr::config(v, e, unit);
+                const auto [data, extra] = blocks(total, qr::cap(), per_page, file_ecc);
+                if (data == 0) break;
+                const auto pages = (data + per_page - 1) / per_page + (extra + per_page - 1) / per_page;
+                if (e != 0 && pages > c.pages) break;
+                c.ecc = e;
+                c.pages = pages;
+            }
+            if (c.pages == 0) continue;
+
+            const double page_px = static_cast<double>(col * cell + qr::sp()) * (row * cell + qr::sp()) * (use_colour ? 3 : 1); // 彩色页每个平面单独识别
+            c.cost = static_cast<double>(c.pages) * (page_px * cost_px + static_cast<double>(per_page) * n * n * cost_module);
+            if (best.pages == 0 || c.pages < best.pages || (c.pages == best.pages && c.cost < best.cost)) best = c;
+        }
+        if (best.pages == 0) return false;
+
+        std::cout << "Layout: " << best.col << " x " << best.row << ", QR " << best.version << "-" << "LMQH"[best.ecc]
+                  << ", " << unit << " px/module, ~" << best.pages << " pages" << std::endl << std::endl;
+
+        qr::config(best.version, best.ecc, unit);
+        page::config(best.col, best.row, use_colour);
+        if (!file::fits()) { // 总字节数按最大容量统计，需按所选版本重新检查
+            std::cout << "Error: " << total << " bytes do not fit in " << qrb::index::max() << " blocks of QR " << best.version << "-" << "LMQH"[best.ecc] << std::endl;
+            return false;
+        }
+        file::incremental(render_key(best.col, best.row, best.version, best.ecc));
+        file::verify(use_verify);
+        return page::cap() <= static_cast<int>(index::max()) && arrange();
+    }
+
+    bool format(const std::string& ext) {
+        const auto e = ext.starts_with('.') ? ext : "." + ext;
+        if (!page::writable(e)) return false;
+
+        page_ext = e;
+        return true;
+    }
+
+    bool rateless(const int percent) {
+        if (percent < 0 || percent > 1000) return false;
+
+        repair_ratio = percent;
+        return true;
+    }
+
+    bool erasure(const int k, const int m) {
+        if (k < 1 || m < 1 || k + m > 256) return false;
+
+        rs_k = k;
+        rs_m = m;
+        return true;
+    }
+
+    void compress(const bool enable) { use_zip = enable; }
+
+    void select(const std::string& name) { only.push_back(name); }
+
+    void colour(const bool enable) { use_colour = enable; }
+
+    void incremental(const bool enable) { use_delta = enable; }
 
-        return file::config(input_file, output_dir); // file依赖qr、index和page，需最后配置
+    void verify(const bool enable) { use_verify = enable; }
+
+    bool costs(const fs::path& profile) {
+        std::ifstream input(profile);
+        if (!input.is_open()) return false;
+
+        auto px = cost_px, module = cost_module;
+        std::string key;
+        double value = 0.0;
+        while (input >> key >> value) {
+            if (value < 0.0) return false;
+            if (key == "cost_px") px = value;
+            else if (key == "cost_module") module = value;
+            else return false;
+        }
+        if (!input.eof() || px + module <= 0.0) return false;
+
+        cost_px = px;
+        cost_module = module;
+        return true;
+    }
+
+    bool tuning(const fs::path& profile) {
+        std::ifstream input(profile);
+        if (!input.is_open()) return false;
+
+        auto p = page::tuned();
+        std::string key;
+        double value = 0.0;
+        while (input >> key >> value) {
+            if (key == "tolerance") p.tolerance = static_cast<float>(value);
+            else if (key == "roi_scale") p.roi_scale = value;
+            else if (key == "roi_tries") p.roi_tries = static_cast<int>(value);
+            else if (key == "passes") p.passes = static_cast<int>(value);
+            else if (key == "filter_d") p.filter_d = static_cast<int>(value);
+            else if (key == "filter_sigma") p.filter_sigma = value;
+            else if (key == "binarizer") p.binarizer = static_cast<int>(value);
+            else if (key == "try_harder") p.try_harder = value != 0.0;
+            else return false;
+        }
+        return input.eof() && page::tune(p);
+    }
+
+    bool tune(const fs::path& corpus_dir, const fs::path& profile) {
+        if (!fs::exists(corpus_dir, err) || err || !fs::is_directory(corpus_dir, err) || err) return false;
+
+        std::vector<fs::path> images;
+        for (const auto& entry : fs::directory_iterator(corpus_dir, err)) if (entry.is_regular_file(err)) images.push_back(entry.path());
+        if (images.empty() || !std::ofstream(profile, std::ios::app).is_open()) return false;
+        std::ranges::sort(images);
+
+        // 逐个参数在候选值中选择最优，其余参数保持当前最优值，直到一轮中没有改进
+        using setter = std::function<void(page::params&, double)>;
+        const std::vector<std::pair<std::vector<double>, setter>> space = {
+            {{0, 5, 9}, [](page::params& p, const double v) { p.filter_d = static_cast<int>(v); }},
+            {{15, 30, 60}, [](page::params& p, const double v) { p.filter_sigma = v; }},
+            {{0, 1, 2}, [](page::params& p, const double v) { p.binarizer = static_cast<int>(v); }},
+            {{1.0 / 32, 1.0 / 16, 1.0 / 8}, [](page::params& p, const double v) { p.tolerance = static_cast<float>(v); }},
+            {{1.05, 1.10, 1.15, 1.25, 1.35}, [](page::params& p, const double v) { p.roi_scale = v; }},
+            {{1, 2, 16}, [](page::params& p, const double v) { p.roi_tries = static_cast<int>(v); }},
+            {{1, 2, 3}, [](page::params& p, const double v) { p.passes = static_cast<int>(v); }},
+            {{1, 0}, [](page::params& p, const double v) { p.try_harder = v != 0.0; }},
+        };
+
+        auto best_params = page::tuned(); // 从当前参数出发，可在已有参数文件的基础上继续调整
+        const auto base = evaluate(images);
+        auto best = base;
+        int trials = 1;
+        std::cout << std::format("Images:  {}", images.size()) << std::endl
+                  << std::format("Initial: {} symbols, {:.1f} symbols/s", base.symbols, base.rate()) << std::endl;
+
+        for (bool improved = true; improved;) {
+            improved = false;
+            for (const auto& [values, set] : space) {
+                for (const auto v : values) {
+                    auto p = best_params;
+                    set(p, v);
+                    if (dump_params(p) == dump_params(best_params) || (p.filter_d == 0 && p.filter_sigma != best_params.filter_sigma) || !page::tune(p)) continue; // 不滤波时标准差无效
+
+                    const auto s = evaluate(images);
+                    std::cout << "\r" << std::format(" Trial {} [Tune] [Best: {} symbols, {:.1f} symbols/s]", ++trials, best.symbols, best.rate()) << std::flush;
+                    if (!better(s, best)) continue;
+
+                    best = s;
+                    best_params = p;
+                    improved = true;
+                }
+                page::tune(best_params);
+            }
+        }
+
+        std::ofstream(profile, std::ios::binary) << dump_params(best_params);
+
+        std::cout << std::endl << std::endl << std::format("Tuned:   {} symbols, {:.1f} symbols/s", best.symbols, best.rate()) << std::endl
+                  << dump_params(best_params) << "Profile: " << profile.string() << std::endl;
+        return true;
+    }
+
+    bool profile(const fs::path& trace, const bool counters) { return probe::enable(trace, counters); }
+
+    bool band(const int rows) {
+        auto p = page::tuned();
+        p.band = rows;
+        return rows >= 1 && page::tune(p);
+    }
+
+    bool telemetry(const fs::path& file) { return progress::events(file); }
+
+    bool container(const int version) {
+        if (version != 1 && version != 2) return false;
+
+        layout = version;
+        return true;
     }
 
     bool config(const fs::path& input_dir, const fs::path& output_dir, const fs::path& ecc_dir) {
         if (!fs::exists(input_dir, err) || err || !fs::is_directory(input_dir, err) || err) return false;
-        if (!fs::exists(ecc_dir, err) || err || !fs::is_directory(ecc_dir, err) || err) return false;
+        if (!ecc_dir.empty() && (!fs::exists(ecc_dir, err) || err || !fs::is_directory(ecc_dir, err) || err)) return false;
 
         qr::fresh();
         index::config(0);
+        fountain::clean();
+        rs::clean();
+        slot::clean();
+        pending.clear();
+        plain = false;
+        out_dir = output_dir;
 
         return file::config(input_dir, output_dir, ecc_dir);
     }
 
-    void clean() { file::clean(); }
+    void clean() {
+        page::close();
+        file::clean();
+        probe::dump();
+    }
 
     void write() {
+        probe::zone zone("encode");
+        if (repair_ratio >= 0) { write_fountain(); return; }
+        if (slot::active()) { write_slot(); return; }
+
         // [0] -> 文件 [1] -> 奇偶校验
         std::array buffer = {std::valarray<uint8_t>(qr::cap() * page::cap()), std::valarray<uint8_t>(static_cast<uint8_t>(0), qr::cap() * page::cap())};
         std::array<uint32_t, 2> index = {1, 0};
         std::array<uint64_t, 2> offset = {0, 0};
 
         const bool use_ecc = index::step() != 1;
+        const bool use_rs = rs::total() != 0;
+        std::vector<uint8_t> source; // 纠删码需要完整的源数据流
         bool stop = false;
 
+        progress::start("Encode", file::streaming() ? 0 : file::total(), "bytes"); // 流式读取时总量未知
         while (!stop) { // 按块循环，按页缓冲
             uint64_t beg = offset[0];
 
+            if (index[0] > index::max()) { // 流式读取时才可能超出序号上限
+                progress::finish();
+                std::cout << std::endl << std::endl << "Error: Input exceeds " << index::max() << " blocks" << std::endl;
+                return;
+            }
+
             auto len = qr::cap() - index::len(index[0]);
             if (const auto flg_len = index::len(0); flg_len + file::remain() <= len) { // 文件块尾块
                 offset[0] += index::encode(0, std::span{buffer[0]}.subspan(offset[0]), false);
@@ -59,7 +659,9 @@ namespace qrb {
                 stop = true;
             }
             offset[0] += index::encode(index[0], std::span{buffer[0]}.subspan(offset[0]), false);;
-            offset[0] += file::read(buffer[0], offset[0], len);
+            const auto n = file::read(buffer[0], offset[0], len);
+            if (use_rs) source.insert(source.end(), std::begin(buffer[0]) + offset[0], std::begin(buffer[0]) + offset[0] + n);
+            offset[0] += n;
 
             if (use_ecc) {// 处理奇偶校验
                 buffer[1][std::slice(offset[1],offset[0] - beg,1)] ^= buffer[0][std::slice(beg,offset[0] - beg,1)];
@@ -71,74 +673,85 @@ namespace qrb {
             }
 
             for (int c = 0; c <= use_ecc; ++c) if (offset[c] == buffer[c].size() || stop) { // 换页
-                file::write(std::span{buffer[c]}.first(offset[c]), std::to_string((index[c] + page::cap() - 1) / page::cap()) + ".png", c);
+                file::write(std::span{buffer[c]}.first(offset[c]), std::to_string((index[c] + page::cap() - 1) / page::cap()) + page_ext, c);
                 offset[c] = 0;
                 if (c == 1) buffer[c] = 0; // 奇偶校验缓冲置零
             }
 
             ++index[0]; // 文件块换块
-
-            std::cout << "\r"
-                      << std::format(" {:>4.1f}% [Encode]", 99.9 * (1 - static_cast<double>(file::remain()) / static_cast<double>(file::total())))
-                      << std::flush;
+            progress::set(file::total() - file::remain());
         }
+        progress::finish();
+
+        if (use_rs) write_erasure(source);
 
-        std::cout << "\r" << "100.0%" << std::endl << std::endl << "Blocks: " << index[0] - 1;
+        std::cout << "Blocks: " << index[0] - 1;
         if (use_ecc) std::cout << " + " << index[1] << "(ECC)";
+        if (use_rs) std::cout << " + " << rs::stripes() * rs::parity() << "(RS)";
         std::cout << std::endl;
+        report();
     }
     
     void read() {
+        probe::zone zone("decode");
+        if (!only.empty()) { read_only(); return; }
+
         // [0] -> 文件 [1] -> 奇偶校验
         std::array<std::unordered_map<uint32_t, bool>, 2> index{};
         std::optional<uint32_t> last_index;
+        std::vector<uint8_t> source; // 喷泉码恢复的源数据
 
+        progress::start("Decode", file::total(), "images");
         while (file::remain() != 0) {
-            std::cout << "\r" << "Check  [Decode] [Total: "
-                      << std::format(" {:>4.1f}%", 99.9 * (1 - static_cast<double>(file::remain()) / static_cast<double>(file::total())))
-                      << "]" << std::flush;
-
             const auto [data, is_ecc] = file::read();
 
-            for (const auto& block : data) {
-                auto [idx, len] = index::decode(block, is_ecc);
-
-                if (len == 0 || (!is_ecc && last_index.has_value() && idx > last_index)) continue; // 序号合法性检查
-                if (index[is_ecc].contains(idx)) continue; // 去重
-                if (block.size() == len || ((is_ecc || idx != 0) && block.size() != qr::cap())) continue; // 块长度合法性检查
+            accept(data, is_ecc, index, last_index);
 
-                uint32_t offset = len;
+            progress::found(fountain::count() != 0 ? fountain::received() : index[0].size() + index[1].size());
+            progress::advance();
 
-                if (idx == 0 && !last_index.has_value() && !is_ecc) { // 文件块尾块
-                    std::tie(idx, len) = index::decode(std::span{block}.subspan(offset), false);
-                    if (len == 0 || index[0].contains(idx) || idx == 0) continue; // 尾块序号合法性检查
-                    last_index = idx;
-                    offset += len;
-                }
-
-                file::write(block, offset, idx, is_ecc);
-                index[is_ecc][idx] = true;
-            }
-
-            std::cout << "\r" << "100.0%" << std::flush;
+            // 喷泉码只需足够数量的任意符号，恢复后不再读取剩余图像
+            if (fountain::count() != 0 && fountain::received() >= fountain::count() && fountain::solve(source)) break;
         }
+        settle(index, last_index);
 
-        std::cout << "\r" << "100.0% [Decode] [Total: 100.0%]" << std::flush;
-
-        file::repair(index, last_index.has_value());
+        progress::finish();
+        refuse();
 
-        std::cout << std::endl << std::endl << "Blocks:  " << index[0].size() << " / ";
-        if (last_index.has_value()) std::cout << last_index.value() << std::endl; else std::cout << "?" << std::endl;
-
-        if (!last_index.has_value() || index[0].size() != last_index) { // 存在缺块
-            std::cout << "Missing:";
-            if (const auto m = std::ranges::max(index[0] | std::views::keys); index[0].size() != m) {
-                for (uint32_t i = 1; i <= m; ++i) if (!index[0].contains(i)) std::cout << " [" << i << "]";
-                if (!last_index.has_value()) std::cout << " and more";
+        if (fountain::count() != 0) {
+            std::cout << "Symbols: " << fountain::received() << " / " << fountain::count() << std::endl;
+            progress::emit("symbols", std::format(R"("received": {}, "needed": {}, "solved": {})", fountain::received(), fountain::count(), source.empty() ? "false" : "true"));
+            if (source.empty()) {
+                std::cout << "Missing: More symbols" << std::endl;
+                return;
+            }
+            file::restore(source);
+        } else {
+            file::repair(index, last_index);
+
+            std::cout << "Blocks:  " << index[0].size() << " / ";
+            if (last_index.has_value()) std::cout << last_index.value() << std::endl; else std::cout << "?" << std::endl;
+            progress::emit("blocks", std::format(R"("found": {}, "total": {})", index[0].size(), last_index.has_value() ? std::to_string(last_index.value()) : "null"));
+
+            if (!last_index.has_value() || index[0].size() != last_index) { // 存在缺块
+                std::string ranges; // 缺失序号按连续区间合并
+                std::cout << "Missing:";
+                if (const auto m = index[0].empty() ? 0 : std::ranges::max(index[0] | std::views::keys); index[0].size() != m) {
+                    for (uint32_t i = 1; i <= m; ++i) {
+                        if (index[0].contains(i)) continue;
+                        std::cout << " [" << i << "]";
+                        auto j = i;
+                        while (j < m && !index[0].contains(j + 1)) std::cout << " [" << ++j << "]";
+                        ranges += std::format("{}[{}, {}]", ranges.empty() ? "" : ", ", i, j);
+                        i = j;
+                    }
+                    if (!last_index.has_value()) std::cout << " and more";
+                }
+                else std::cout << " Unknown";
+                std::cout << std::endl;
+                progress::emit("missing", std::format(R"("ranges": [{}], "more": {})", ranges, last_index.has_value() ? "false" : "true"));
+                return;
             }
-            else std::cout << " Unknown";
-            std::cout << std::endl;
-            return;
         }
 
         auto [file_size, timestamp, file_name] = file::metadata();
@@ -0,0 +1,218 @@
+#include <array>
+#include <algorithm>
+#include <unordered_map>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define GF_TARGET_SSSE3
+#else
+#define GF_TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
+#define GF_SSSE3
+#endif
+
+#include <qrb/rs.h>
+
+namespace {
+    constexpr uint32_t head_len = 12; // 标记0、k、m、行号各1字节，组号3字节，总字节数5字节
+
+    // GF(256)，本原多项式0x11D
+    constexpr auto gf_exp = [] {
+        std::array<uint8_t, 512> table{};
+        uint32_t x = 1;
+        for (int i = 0; i < 255; ++i) {
+            table[i] = table[i + 255] = static_cast<uint8_t>(x);
+            x <<= 1;
+            if (x & 0x100) x ^= 0x11D;
+        }
+        return table;
+    }();
+
+    constexpr auto gf_log = [] {
+        std::array<uint8_t, 256> table{};
+        for (int i = 0; i < 255; ++i) table[gf_exp[i]] = static_cast<uint8_t>(i);
+        return table;
+    }();
+
+    uint8_t mul(const uint8_t a, const uint8_t b) { return a == 0 || b == 0 ? 0 : gf_exp[gf_log[a] + gf_log[b]]; }
+    uint8_t inv(const uint8_t a) { return gf_exp[255 - gf_log[a]]; }
+
+    uint64_t src_len = 0;
+    uint32_t sym_len = 0;
+    uint32_t num_k = 0;
+    uint32_t num_m = 0;
+    uint32_t num_s = 0;
+
+    std::unordered_map<uint64_t, std::vector<uint8_t>> received; // 组号 * m + 行号 => 校验数据
+
+    uint8_t coef(const uint32_t row, const uint32_t col) { return inv(static_cast<uint8_t>(row ^ (num_m + col))); } // 柯西矩阵，任意k阶子式可逆
+
+    void setup(const uint64_t total, const uint32_t length, const uint32_t k, const uint32_t m) {
+        src_len = total;
+        sym_len = length;
+        num_k = k;
+        num_m = m;
+        num_s = static_cast<uint32_t>(((total + length - 1) / length + k - 1) / k);
+    }
+
+#ifdef GF_SSSE3
+    bool detect() {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] >> 9) & 1;
+#else
+        return __builtin_cpu_supports("ssse3");
+#endif
+    }
+
+    const bool has_ssse3 = detect();
+
+    GF_TARGET_SSSE3 size_t mul_add_ssse3(uint8_t* dst, const uint8_t* src, const size_t size, const uint8_t* lo, const uint8_t* hi) {
+        // 高低半字节分别查16项乘积表，每次处理16字节
+        const __m128i tl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lo));
+        const __m128i th = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hi));
+        const __m128i mask = _mm_set1_epi8(0x0F);
+        size_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            const __m128i pl = _mm_shuffle_epi8(tl, _mm_and_si128(v, mask));
+            const __m128i ph = _mm_shuffle_epi8(th, _mm_and_si128(_mm_srli_epi64(v, 4), mask));
+            const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(d, _mm_xor_si128(pl, ph)));
+        }
+        return i;
+    }
+#endif
+
+    void mul_add(const std::span<uint8_t> dst, const std::span<const uint8_t> src, const uint8_t c) { // dst ^= c * src
+        if (c == 0) return;
+
+        alignas(16) std::array<uint8_t, 16> lo{}, hi{};
+        for (uint8_t x = 0; x < 16; ++x) {
+            lo[x] = mul(c, x);
+            hi[x] = mul(c, static_cast<uint8_t>(x << 4));
+        }
+
+        size_t i = 0;
+#ifdef GF_SSSE3
+        if (has_ssse3) i = mul_add_ssse3(dst.data(), src.data(), src.size(), lo.data(), hi.data());
+#endif
+        for (; i < src.size(); ++i) dst[i] ^= lo[src[i] & 0x0F] ^ hi[src[i] >> 4];
+    }
+}
+
+namespace qrb::rs {
+    bool config(const uint64_t total, const uint32_t cap, const uint32_t k, const uint32_t m) {
+        clean();
+        if (total == 0 || total > max_total || cap <= head_len || k < 1 || m < 1 || k + m > 256) return false;
+
+        setup(total, cap - head_len, k, m);
+        return num_s < (1U << 24);
+    }
+
+    uint64_t total() { return src_len; }
+    uint32_t symbol() { return sym_len; }
+    uint32_t data() { return num_k; }
+    uint32_t parity() { return num_m; }
+    uint32_t stripes() { return num_s; }
+
+    void encode(const uint32_t stripe, const std::span<const uint8_t> source, const std::span<uint8_t> blocks) {
+        const auto cap = head_len + sym_len;
+        for (uint32_t j = 0; j < num_m; ++j) {
+            const auto block = blocks.subspan(static_cast<size_t>(j) * cap, cap);
+            block[0] = 0;
+            block[1] = static_cast<uint8_t>(num_k);
+            block[2] = static_cast<uint8_t>(num_m);
+            block[3] = static_cast<uint8_t>(j);
+            for (int i = 0; i < 3; ++i) block[4 + i] = static_cast<uint8_t>((stripe >> (8 * (2 - i))) & 0xFF);
+            for (int i = 0; i < 5; ++i) block[7 + i] = static_cast<uint8_t>((src_len >> (8 * (4 - i))) & 0xFF);
+            std::ranges::fill(block.subspan(head_len), 0);
+        }
+
+        for (uint32_t p = 0; p < num_k; ++p) { // 每个数据符号只读取一次，累加到所有校验行
+            const auto beg = (static_cast<uint64_t>(p) * num_s + stripe) * sym_len;
+            if (beg >= source.size()) break;
+            const auto src = source.subspan(beg, std::min<uint64_t>(sym_len, source.size() - beg)); // 末符号不足部分视为零
+            for (uint32_t j = 0; j < num_m; ++j) mul_add(blocks.subspan(static_cast<size_t>(j) * cap + head_len, sym_len), src, coef(j, p));
+        }
+    }
+
+    bool check(const std::span<const uint8_t> block) { return block.size() > head_len && block[0] == 0 && block[1] != 0 && block[2] != 0; }
+
+    bool insert(const std::span<const uint8_t> block) {
+        if (!check(block)) return false;
+
+        const uint32_t k = block[1], m = block[2], j = block[3];
+        uint32_t stripe = 0;
+        uint64_t total = 0;
+        for (int i = 0; i < 3; ++i) stripe = (stripe << 8) | block[4 + i];
+        for (int i = 0; i < 5; ++i) total = (total << 8) | block[7 + i];
+
+        if (num_k == 0) {
+            if (total == 0 || k + m > 256) return false;
+            setup(total, static_cast<uint32_t>(block.size() - head_len), k, m);
+        }
+        if (k != num_k || m != num_m || total != src_len || block.size() != head_len + sym_len || j >= num_m || stripe >= num_s) return false;
+
+        received.try_emplace(static_cast<uint64_t>(stripe) * num_m + j, block.begin() + head_len, block.end());
+        return true;
+    }
+
+    bool solve(const uint32_t stripe, std::vector<std::vector<uint8_t>>& symbols, const std::vector<bool>& known) {
+        std::vector<uint32_t> missing, rows;
+        for (uint32_t p = 0; p < num_k; ++p) if (!known[p]) missing.push_back(p);
+        if (missing.empty()) return true;
+        for (uint32_t j = 0; j < num_m && rows.size() < missing.size(); ++j) if (received.contains(static_cast<uint64_t>(stripe) * num_m + j)) rows.push_back(j);
+        if (rows.size() < missing.size()) return false; // 缺失数超过可用校验数
+
+        const auto e = missing.size();
+
+        // 校正子：校验数据减去已知数据符号的贡献
+        std::vector<std::vector<uint8_t>> syndrome(e);
+        for (size_t r = 0; r < e; ++r) {
+            syndrome[r] = received.at(static_cast<uint64_t>(stripe) * num_m + rows[r]);
+            for (uint32_t p = 0; p < num_k; ++p) if (known[p]) mul_add(syndrome[r], symbols[p], coef(rows[r], p));
+        }
+
+        // 求缺失位置对应的柯西子矩阵的逆
+        std::vector<std::vector<uint8_t>> a(e, std::vector<uint8_t>(2 * e, 0));
+        for (size_t r = 0; r < e; ++r) {
+            for (size_t c = 0; c < e; ++c) a[r][c] = coef(rows[r], missing[c]);
+            a[r][e + r] = 1;
+        }
+        for (size_t c = 0; c < e; ++c) {
+            size_t p = c;
+            while (p < e && a[p][c] == 0) ++p;
+            if (p == e) return false;
+            std::swap(a[p], a[c]);
+
+            const auto f = inv(a[c][c]);
+            for (auto& x : a[c]) x = mul(x, f);
+            for (size_t r = 0; r < e; ++r) {
+                if (r == c || a[r][c] == 0) continue;
+                const auto g = a[r][c];
+                for (size_t x = 0; x < 2 * e; ++x) a[r][x] ^= mul(g, a[c][x]);
+            }
+        }
+
+        for (size_t c = 0; c < e; ++c) {
+            auto& dst = symbols[missing[c]];
+            std::ranges::fill(dst, 0);
+            for (size_t r = 0; r < e; ++r) mul_add(dst, syndrome[r], a[c][e + r]);
+        }
+
+        return true;
+    }
+
+    void clean() {
+        src_len = 0;
+        sym_len = 0;
+        num_k = 0;
+        num_m = 0;
+        num_s = 0;
+        std::unordered_map<uint64_t, std::vector<uint8_t>>().swap(received);
+    }
+}
@@ -0,0 +1,134 @@
+#include <optional>
+
+#include <qrb/slot.h>
+
+// 每页首末两块与尾块为定位块，头部4字节，每字节最高位均为1，作为v1变长序号时超出最大长度而非法，故可与v1共存
+// 去除最高位后的28位依次为页号14位、页内位置7位、每页二维码个数减1共7位，定位块均可单独确定序号
+// 其余为紧凑块，头部2字节，首字节为页内位置，最高位为0，次字节为页号的低8位；页号取同一图像中低位相同的定位块，
+// 读到尾块得知总块数后，低位只对应一页时也可单独定位；每块平均头部为2 + 4 / 每页个数字节
+// 尾块总是定位块，不足整块，由长度识别
+namespace {
+    constexpr uint32_t base_len = 4;
+    constexpr uint32_t compact_len = 2;
+    constexpr uint32_t pos_bits = 7;
+    constexpr uint32_t page_bits = 14;
+    constexpr uint32_t max_page = 1U << page_bits;
+    constexpr uint32_t low_pages = 256; // 紧凑块中页号低位可区分的页数
+    static_assert(qrb::slot::max_cap == 1U << pos_bits);
+
+    bool is_v2 = false;
+    uint32_t blk_cnt = 0;
+    uint32_t page_cap = 0;
+
+    bool is_base(const uint32_t pos) { return pos == 0 || pos + 1 == page_cap; }
+
+    uint32_t resolve(const std::span<const uint8_t> block, const std::vector<uint32_t>& pages) { // 紧凑块的序号，无法唯一确定页号时为0
+        const uint32_t pos = block[0], low = block[1];
+        std::optional<uint32_t> page;
+        for (const auto p : pages) {
+            if (p % low_pages != low) continue;
+            if (page.has_value() && page != p) return 0; // 同一图像中有两页低位相同
+            page = p;
+        }
+        if (!page.has_value() && blk_cnt != 0) { // 由总页数判断低位是否只对应一页
+            const auto total = (blk_cnt - 1) / page_cap + 1;
+            if (low < total && low + low_pages >= total) page = low;
+        }
+        if (!page.has_value()) return 0;
+
+        const auto index = *page * page_cap + pos + 1;
+        return blk_cnt != 0 && index >= blk_cnt ? 0 : index; // 尾块总是定位块
+    }
+}
+
+namespace qrb::slot {
+    bool config(const uint64_t total, const uint32_t cap, const uint32_t per_page) {
+        clean();
+        if (cap <= base_len || per_page < 1 || per_page > max_cap) return false;
+        page_cap = per_page;
+
+        // 整页跳过，再逐块确定尾块；尾块为定位块，总是不足整块，可能仅有头部
+        const auto page_len = static_cast<uint64_t>(cap) * page_cap - overhead(page_cap);
+        uint64_t n = total / page_len * page_cap, used = n / page_cap * page_len;
+        while (true) {
+            ++n;
+            if (total - used < cap - base_len) break;
+            used += cap - len(static_cast<uint32_t>(n));
+        }
+        if ((n - 1) / page_cap >= max_page) { page_cap = 0; return false; }
+
+        is_v2 = true;
+        blk_cnt = static_cast<uint32_t>(n);
+        return true;
+    }
+
+    uint32_t len(const uint32_t index) { return index == blk_cnt || is_base((index - 1) % page_cap) ? base_len : compact_len; }
+
+    uint32_t len() { return base_len; }
+
+    uint32_t overhead(const uint32_t per_page) { return per_page == 1 ? base_len : 2 * base_len + (per_page - 2) * compact_len; }
+
+    uint64_t sum(const uint32_t index) {
+        const uint64_t pages = (index - 1) / page_cap, pos = (index - 1) % page_cap;
+        return pages * overhead(page_cap) + (pos == 0 ? 0 : base_len + (pos - 1) * compact_len);
+    }
+
+    uint32_t count() { return blk_cnt; }
+
+    uint32_t cap() { return page_cap; }
+
+    bool active() { return is_v2; }
+
+    void last(const uint32_t index) { blk_cnt = index; }
+
+    void encode(const uint32_t index, std::span<uint8_t> data) {
+        const auto page = (index - 1) / page_cap, pos = (index - 1) % page_cap;
+        if (index != blk_cnt && !is_base(pos)) {
+            data[0] = static_cast<uint8_t>(pos);
+            data[1] = static_cast<uint8_t>(page % low_pages);
+            return;
+        }
+
+        const auto value = page << (2 * pos_bits) | pos << pos_bits | (page_cap - 1);
+        for (uint32_t i = 0; i < base_len; ++i) data[i] = static_cast<uint8_t>(0x80 | ((value >> (7 * (base_len - 1 - i))) & 0x7F));
+    }
+
+    bool check(const std::span<const uint8_t> block) {
+        if (block.size() < base_len) return false;
+        for (uint32_t i = 0; i < base_len; ++i) if ((block[i] & 0x80) == 0) return false;
+        return true;
+    }
+
+    std::vector<uint32_t> decode(const std::vector<std::vector<uint8_t>>& blocks) {
+        std::vector<uint32_t> result(blocks.size(), 0);
+        std::vector<uint32_t> pages; // 本图像中定位块的页号
+
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            if (!check(blocks[i])) continue;
+
+            uint32_t value = 0;
+            for (uint32_t j = 0; j < base_len; ++j) value = (value << 7) | (blocks[i][j] & 0x7F);
+            const auto p = value >> (2 * pos_bits), pos = (value >> pos_bits) & (max_cap - 1), c = (value & (max_cap - 1)) + 1;
+            if ((page_cap != 0 && c != page_cap) || pos >= c) continue; // 与已知的每页个数矛盾或超出页面
+            if (blk_cnt != 0 && p * c + pos + 1 > blk_cnt) continue;     // 在尾块之后
+
+            is_v2 = true;
+            page_cap = c;
+            pages.push_back(p);
+            result[i] = p * c + pos + 1;
+        }
+        if (!is_v2) return result;
+
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            const auto& block = blocks[i];
+            if (result[i] == 0 && block.size() >= compact_len && block[0] >= 1 && block[0] + 1U < page_cap) result[i] = resolve(block, pages);
+        }
+        return result;
+    }
+
+    void clean() {
+        is_v2 = false;
+        blk_cnt = 0;
+        page_cap = 0;
+    }
+}
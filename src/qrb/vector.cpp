@@ -0,0 +1,136 @@
+#include <map>
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <charconv>
+
+#include <qrb/zip.h>
+#include <qrb/vector.h>
+
+namespace {
+    struct document { // 逐页追加的PDF文档，对象1为目录，对象2为页树，均在结束时写入
+        std::ofstream stream;
+        std::vector<uint64_t> offset; // 各对象在文件中的偏移，下标为对象号减1
+        std::vector<size_t> page;     // 各页对象号
+    };
+
+    std::map<fs::path, document> docs;
+
+    void append(std::string& s, const int value) { // 不受区域设置影响的整数格式化
+        std::array<char, 16> buf{};
+        const auto [end, ec] = std::to_chars(buf.data(), buf.data() + buf.size(), value);
+        s.append(buf.data(), end);
+    }
+
+    bool pdf(const fs::path& file, const int width, const int height, const std::vector<cv::Rect>& rects) {
+        const auto dir = file.parent_path();
+        const auto path = dir / (dir.filename().string() + ".pdf");
+
+        auto& doc = docs[path];
+        if (!doc.stream.is_open()) {
+            doc.stream.open(path, std::ios::binary | std::ios::trunc);
+            if (!doc.stream.is_open()) { docs.erase(path); return false; }
+            doc.stream << "%PDF-1.4\n%\xE2\xE3\xCF\xD3\n";
+            doc.offset.assign(2, 0);
+        }
+
+        // PDF坐标原点在左下角，单位沿用像素，打印时由阅读器缩放
+        std::string content = "0 g\n";
+        content.reserve(rects.size() * 18);
+        for (const auto& r : rects) {
+            append(content, r.x);
+            content += ' ';
+            append(content, height - r.y - r.height);
+            content += ' ';
+            append(content, r.width);
+            content += ' ';
+            append(content, r.height);
+            content += " re\n";
+        }
+        content += "f\n";
+        const auto binary = qrb::zip::compress({reinterpret_cast<const uint8_t*>(content.data()), content.size()});
+
+        const auto id = doc.offset.size() + 1;
+        doc.offset.push_back(doc.stream.tellp());
+        doc.stream << id << " 0 obj\n<< /Length " << binary.size() << " /Filter /FlateDecode >>\nstream\n";
+        doc.stream.write(reinterpret_cast<const char*>(binary.data()), static_cast<int64_t>(binary.size()));
+        doc.stream << "\nendstream\nendobj\n";
+
+        doc.offset.push_back(doc.stream.tellp());
+        doc.stream << id + 1 << " 0 obj\n<< /Type /Page /Parent 2 0 R /MediaBox [0 0 " << width << " " << height
+                   << "] /Resources << >> /Contents " << id << " 0 R >>\nendobj\n";
+        doc.page.push_back(id + 1);
+
+        return doc.stream.good();
+    }
+
+    void finish(document& doc) { // 写页树、目录与交叉引用表
+        doc.offset[1] = doc.stream.tellp();
+        doc.stream << "2 0 obj\n<< /Type /Pages /Kids [";
+        for (const auto p : doc.page) doc.stream << p << " 0 R ";
+        doc.stream << "] /Count " << doc.page.size() << " >>\nendobj\n";
+
+        doc.offset[0] = doc.stream.tellp();
+        doc.stream << "1 0 obj\n<< /Type /Catalog /Pages 2 0 R >>\nendobj\n";
+
+        const auto xref = static_cast<uint64_t>(doc.stream.tellp());
+        doc.stream << "xref\n0 " << doc.offset.size() + 1 << "\n0000000000 65535 f \n";
+        for (const auto o : doc.offset) {
+            std::array<char, 24> entry{};
+            std::snprintf(entry.data(), entry.size(), "%010llu 00000 n \n", static_cast<unsigned long long>(o)); // 每项固定20字节
+            doc.stream << entry.data();
+        }
+        doc.stream << "trailer\n<< /Size " << doc.offset.size() + 1 << " /Root 1 0 R >>\nstartxref\n" << xref << "\n%%EOF\n";
+        doc.stream.close();
+    }
+
+    bool svg(const fs::path& file, const int width, const int height, const std::vector<cv::Rect>& rects) {
+        std::string content = "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\" width=\"";
+        content.reserve(rects.size() * 24);
+        append(content, width);
+        content += "\" height=\"";
+        append(content, height);
+        content += "\" viewBox=\"0 0 ";
+        append(content, width);
+        content += ' ';
+        append(content, height);
+        content += "\" shape-rendering=\"crispEdges\">\n<rect width=\"100%\" height=\"100%\" fill=\"#fff\"/>\n<path fill=\"#000\" d=\"";
+        for (const auto& r : rects) { // 相对坐标的闭合矩形路径
+            content += 'M';
+            append(content, r.x);
+            content += ' ';
+            append(content, r.y);
+            content += 'h';
+            append(content, r.width);
+            content += 'v';
+            append(content, r.height);
+            content += "h-";
+            append(content, r.width);
+            content += 'z';
+        }
+        content += "\"/>\n</svg>\n";
+
+        std::ofstream output(file, std::ios::binary);
+        if (!output.is_open()) return false;
+        output.write(content.data(), static_cast<int64_t>(content.size()));
+        output.close();
+
+        return true;
+    }
+}
+
+namespace qrb::vector {
+    bool support(const std::string& ext) { return ext == ".pdf" || ext == ".svg"; }
+
+    bool write(const fs::path& file, const int width, const int height, const std::vector<cv::Rect>& rects) {
+        const auto ext = file.extension().string();
+        if (ext == ".pdf") return pdf(file, width, height, rects);
+        if (ext == ".svg") return svg(file, width, height, rects);
+        return false;
+    }
+
+    void close() {
+        for (auto& [path, doc] : docs) finish(doc);
+        docs.clear();
+    }
+}
@@ -0,0 +1,474 @@
+#include <array>
+#include <queue>
+#include <algorithm>
+
+#include <qrb/zip.h>
+
+namespace {
+    constexpr int max_bits = 15;    // 字面量/长度与距离的码长上限
+    constexpr int max_cl_bits = 7;  // 码长码的码长上限
+    constexpr uint32_t min_match = 3;
+    constexpr uint32_t max_match = 258;
+    constexpr uint32_t window = 32768;  // 滑动窗口大小
+    constexpr int hash_bits = 15;
+    constexpr int max_chain = 32;       // 哈希链最大查找次数，经验值
+    constexpr uint32_t max_insert = 32; // 超过该长度的匹配不再逐字节更新哈希链，长游程时保持线性速度
+    constexpr size_t chunk = 1 << 20;   // 流式压缩时每个块的原始字节数，决定内存占用
+
+    // 长度码257-285的基准长度与附加位数
+    constexpr std::array<uint16_t, 29> len_base = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    constexpr std::array<uint8_t, 29> len_extra = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    // 距离码0-29的基准距离与附加位数
+    constexpr std::array<uint16_t, 30> dist_base = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    constexpr std::array<uint8_t, 30> dist_extra = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+    // 码长码的写入顺序
+    constexpr std::array<uint8_t, 19> cl_order = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+    struct token { // dist为0时len为字面量
+        uint16_t len;
+        uint16_t dist;
+    };
+
+    struct bit_writer { // 低位在前的位流
+        std::vector<uint8_t>& out;
+        uint64_t acc = 0;
+        int count = 0;
+
+        void put(const uint32_t bits, const int n) {
+            acc |= static_cast<uint64_t>(bits) << count;
+            count += n;
+            while (count >= 8) {
+                out.push_back(static_cast<uint8_t>(acc & 0xFF));
+                acc >>= 8;
+                count -= 8;
+            }
+        }
+
+        void flush() {
+            if (count > 0) out.push_back(static_cast<uint8_t>(acc & 0xFF));
+            acc = 0;
+            count = 0;
+        }
+    };
+
+    struct bit_reader { // 低位在前的位流，按块调用read读入，读尽时置错误标志并返回零
+        const std::function<size_t(std::span<uint8_t>)>& read;
+        std::array<uint8_t, 4096> in{};
+        size_t pos = 0;
+        size_t end = 0;
+        uint64_t acc = 0;
+        int count = 0;
+        bool error = false;
+
+        uint32_t get(const int n) {
+            while (count < n) {
+                if (pos == end) {
+                    pos = 0;
+                    end = std::min(read(in), in.size());
+                    if (end == 0) { error = true; return 0; }
+                }
+                acc |= static_cast<uint64_t>(in[pos++]) << count;
+                count += 8;
+            }
+            const auto bits = static_cast<uint32_t>(acc & ((1ULL << n) - 1));
+            acc >>= n;
+            count -= n;
+            return bits;
+        }
+
+        void align() { // 丢弃至字节边界
+            acc >>= count % 8;
+            count -= count % 8;
+        }
+    };
+
+    struct huffman { // 规范哈夫曼解码表，按码长计数与按码值排序的符号
+        std::array<uint16_t, max_bits + 1> count{};
+        std::vector<uint16_t> symbol;
+
+        bool build(const std::span<const uint8_t> len) {
+            count.fill(0);
+            for (const auto l : len) ++count[l];
+            count[0] = 0;
+
+            int left = 1; // 检查码长超额订阅
+            for (int bits = 1; bits <= max_bits; ++bits) {
+                left = (left << 1) - count[bits];
+                if (left < 0) return false;
+            }
+
+            std::array<uint16_t, max_bits + 1> offset{};
+            for (int bits = 1; bits < max_bits; ++bits) offset[bits + 1] = offset[bits] + count[bits];
+            symbol.assign(len.size(), 0);
+            for (size_t i = 0; i < len.size(); ++i) if (len[i] != 0) symbol[offset[len[i]]++] = static_cast<uint16_t>(i);
+            return true;
+        }
+
+        int decode(bit_reader& br) const { // 逐位解码，码值不存在时返回-1
+            int code = 0, first = 0, index = 0;
+            for (int bits = 1; bits <= max_bits; ++bits) {
+                code |= static_cast<int>(br.get(1));
+                if (br.error) return -1;
+                if (code - count[bits] < first) return symbol[index + code - first];
+                index += count[bits];
+                first = (first + count[bits]) << 1;
+                code <<= 1;
+            }
+            return -1;
+        }
+    };
+
+    uint32_t adler32(const std::span<const uint8_t> data, const uint32_t adler = 1) { // 可由上一段的结果继续累计
+        uint32_t a = adler & 0xFFFF, b = adler >> 16;
+        for (size_t i = 0; i < data.size();) {
+            for (const size_t end = std::min(data.size(), i + 5552); i < end; ++i) { // 5552为不溢出的最大批量
+                a += data[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+        }
+        return (b << 16) | a;
+    }
+
+    struct window_writer { // 解压输出，保留最近一个窗口供回溯，更早的数据分片写出并累计校验值
+        const std::function<void(std::span<const uint8_t>)>& write;
+        uint64_t limit = 0;
+        std::vector<uint8_t> buf;
+        uint64_t flushed = 0;
+        uint32_t adler = 1;
+
+        bool over(const uint64_t extra = 0) const { return flushed + buf.size() + extra > limit; }
+
+        void spill(const size_t keep) { // 写出除最后keep字节外的数据
+            if (buf.size() <= keep) return;
+            const auto n = buf.size() - keep;
+            adler = adler32(std::span{buf}.first(n), adler);
+            write(std::span{buf}.first(n));
+            flushed += n;
+            buf.erase(buf.begin(), buf.begin() + static_cast<int64_t>(n));
+        }
+    };
+
+    bool inflate_block(bit_reader& br, const huffman& lit, const huffman& dist, window_writer& out) { // 解码一个哈夫曼块
+        while (true) {
+            const auto sym = lit.decode(br);
+            if (sym < 0 || sym > 285) return false;
+            if (sym == 256) return true;
+            if (sym < 256) out.buf.push_back(static_cast<uint8_t>(sym));
+            else {
+                const auto lc = sym - 257;
+                const auto len = len_base[lc] + br.get(len_extra[lc]);
+                const auto dc = dist.decode(br);
+                if (dc < 0 || dc > 29) return false;
+                const auto d = dist_base[dc] + br.get(dist_extra[dc]);
+                if (br.error || d > out.buf.size()) return false;
+
+                for (auto i = out.buf.size() - d, end = i + len; i < end; ++i) out.buf.push_back(out.buf[i]); // 允许与输出重叠
+            }
+
+            if (out.over()) return false;
+            if (out.buf.size() >= 2 * window) out.spill(window);
+        }
+    }
+
+    std::vector<uint8_t> lengths(const std::vector<uint32_t>& freq, const int limit) { // 计算限长的哈夫曼码长
+        std::vector<uint32_t> f(freq);
+        std::vector<uint8_t> result(f.size(), 0);
+
+        for (size_t i = 0; i < f.size() && static_cast<size_t>(std::ranges::count(f, 0U)) + 2 > f.size(); ++i) if (f[i] == 0) f[i] = 1; // 至少两个符号，保证码表完整
+
+        while (true) {
+            using item = std::pair<uint64_t, int>;
+            std::priority_queue<item, std::vector<item>, std::greater<>> heap;
+            std::vector<int> parent(2 * f.size(), -1);
+            int next = static_cast<int>(f.size());
+
+            for (size_t i = 0; i < f.size(); ++i) if (f[i] > 0) heap.emplace(f[i], static_cast<int>(i));
+            while (heap.size() > 1) {
+                const auto a = heap.top(); heap.pop();
+                const auto b = heap.top(); heap.pop();
+                parent[a.second] = parent[b.second] = next;
+                heap.emplace(a.first + b.first, next++);
+            }
+
+            std::vector<int> depth(next, 0);
+            for (int i = next - 2; i >= 0; --i) if (parent[i] >= 0) depth[i] = depth[parent[i]] + 1; // 内部节点按创建顺序，根节点最后
+
+            int max_depth = 0;
+            for (size_t i = 0; i < f.size(); ++i) {
+                result[i] = f[i] > 0 ? static_cast<uint8_t>(depth[i]) : 0;
+                max_depth = std::max(max_depth, depth[i]);
+            }
+            if (max_depth <= limit) return result;
+
+            for (auto& v : f) if (v > 0) v = (v + 1) / 2; // 压平频率后重试
+        }
+    }
+
+    std::vector<uint16_t> codes(const std::vector<uint8_t>& len) { // 由码长生成位序反转后的规范哈夫曼码
+        std::array<uint16_t, max_bits + 1> count{}, next{};
+        for (const auto l : len) if (l > 0) ++count[l];
+
+        uint16_t code = 0;
+        for (int bits = 1; bits <= max_bits; ++bits) {
+            code = static_cast<uint16_t>((code + count[bits - 1]) << 1);
+            next[bits] = code;
+        }
+
+        std::vector<uint16_t> result(len.size(), 0);
+        for (size_t i = 0; i < len.size(); ++i) {
+            if (len[i] == 0) continue;
+            uint16_t c = next[len[i]]++, r = 0;
+            for (int k = 0; k < len[i]; ++k, c >>= 1) r = static_cast<uint16_t>((r << 1) | (c & 1));
+            result[i] = r;
+        }
+        return result;
+    }
+
+    std::vector<token> match(const std::span<const uint8_t> data, const size_t start) { // 贪心的哈希链LZ77匹配，start之前的数据只作为回溯窗口
+        std::vector<token> tokens;
+        tokens.reserve((data.size() - start) / 4);
+        std::vector<int32_t> head(1 << hash_bits, -1), prev(window, -1);
+
+        const auto hash = [&](const size_t i) { return ((data[i] << 10) ^ (data[i + 1] << 5) ^ data[i + 2]) & ((1 << hash_bits) - 1); };
+        const auto insert = [&](const size_t i) {
+            if (i + min_match > data.size()) return;
+            const auto h = hash(i);
+            prev[i % window] = head[h];
+            head[h] = static_cast<int32_t>(i);
+        };
+
+        for (size_t i = 0; i < start; ++i) insert(i);
+        for (size_t i = start; i < data.size();) {
+            uint32_t best_len = 0, best_dist = 0;
+            if (i + min_match <= data.size()) {
+                const auto limit = static_cast<uint32_t>(std::min<size_t>(max_match, data.size() - i));
+                int32_t cand = head[hash(i)];
+                for (int chain = 0; chain < max_chain && cand >= 0 && i - cand <= window - 1; ++chain) {
+                    if (data[cand + best_len] == data[i + best_len]) { // 先比较当前最长处，快速排除
+                        uint32_t len = 0;
+                        while (len < limit && data[cand + len] == data[i + len]) ++len;
+                        if (len > best_len) {
+                            best_len = len;
+                            best_dist = static_cast<uint32_t>(i - cand);
+                            if (len == limit) break;
+                        }
+                    }
+                    const auto p = prev[cand % window];
+                    if (p >= cand) break; // 已被窗口覆盖
+                    cand = p;
+                }
+            }
+
+            if (best_len >= min_match) {
+                tokens.push_back({static_cast<uint16_t>(best_len), static_cast<uint16_t>(best_dist)});
+                if (best_len <= max_insert) for (uint32_t k = 0; k < best_len; ++k) insert(i + k);
+                else insert(i);
+                i += best_len;
+            } else {
+                tokens.push_back({data[i], 0});
+                insert(i++);
+            }
+        }
+
+        return tokens;
+    }
+
+    void deflate(const std::span<const uint8_t> data, const size_t start, const bool last, bit_writer& bw) { // 将data[start, end)压缩为一个动态哈夫曼块
+        const auto tokens = match(data, start);
+
+        std::vector<uint32_t> lit_freq(286, 0), dist_freq(30, 0);
+        for (const auto& t : tokens) {
+            if (t.dist == 0) { ++lit_freq[t.len]; continue; }
+            ++lit_freq[257 + (std::ranges::upper_bound(len_base, t.len) - len_base.begin() - 1)];
+            ++dist_freq[std::ranges::upper_bound(dist_base, t.dist) - dist_base.begin() - 1];
+        }
+        ++lit_freq[256];
+
+        const auto lit_len = lengths(lit_freq, max_bits);
+        const auto lit_code = codes(lit_len);
+        const auto dist_len = lengths(dist_freq, max_bits);
+        const auto dist_code = codes(dist_len);
+
+        int hlit = 286, hdist = 30;
+        while (hlit > 257 && lit_len[hlit - 1] == 0) --hlit;
+        while (hdist > 1 && dist_len[hdist - 1] == 0) --hdist;
+
+        // 码长序列的游程编码
+        std::vector<uint8_t> seq(lit_len.begin(), lit_len.begin() + hlit);
+        seq.insert(seq.end(), dist_len.begin(), dist_len.begin() + hdist);
+        std::vector<std::pair<uint8_t, uint8_t>> cl_tokens; // 码长码与附加位
+        std::vector<uint32_t> cl_freq(19, 0);
+        for (size_t i = 0; i < seq.size();) {
+            const auto v = seq[i];
+            size_t run = 1;
+            while (i + run < seq.size() && seq[i + run] == v) ++run;
+            if (v == 0 && run >= 3) {
+                const auto r = std::min<size_t>(run, 138);
+                if (r >= 11) cl_tokens.emplace_back(18, static_cast<uint8_t>(r - 11));
+                else cl_tokens.emplace_back(17, static_cast<uint8_t>(r - 3));
+                i += r;
+            } else if (v != 0 && run >= 4) {
+                const auto r = std::min<size_t>(run - 1, 6);
+                cl_tokens.emplace_back(v, 0);
+                cl_tokens.emplace_back(16, static_cast<uint8_t>(r - 3));
+                i += 1 + r;
+            } else {
+                cl_tokens.emplace_back(v, 0);
+                ++i;
+            }
+        }
+        for (const auto& [sym, extra] : cl_tokens) ++cl_freq[sym];
+
+        const auto cl_len = lengths(cl_freq, max_cl_bits);
+        const auto cl_code = codes(cl_len);
+        int hclen = 19;
+        while (hclen > 4 && cl_len[cl_order[hclen - 1]] == 0) --hclen;
+
+        bw.put(last ? 1 : 0, 1);
+        bw.put(2, 2); // 动态哈夫曼
+        bw.put(hlit - 257, 5);
+        bw.put(hdist - 1, 5);
+        bw.put(hclen - 4, 4);
+        for (int i = 0; i < hclen; ++i) bw.put(cl_len[cl_order[i]], 3);
+        for (const auto& [sym, extra] : cl_tokens) {
+            bw.put(cl_code[sym], cl_len[sym]);
+            if (sym == 16) bw.put(extra, 2);
+            else if (sym == 17) bw.put(extra, 3);
+            else if (sym == 18) bw.put(extra, 7);
+        }
+
+        for (const auto& t : tokens) {
+            if (t.dist == 0) { bw.put(lit_code[t.len], lit_len[t.len]); continue; }
+            const auto lc = std::ranges::upper_bound(len_base, t.len) - len_base.begin() - 1;
+            bw.put(lit_code[257 + lc], lit_len[257 + lc]);
+            if (len_extra[lc] > 0) bw.put(t.len - len_base[lc], len_extra[lc]);
+            const auto dc = std::ranges::upper_bound(dist_base, t.dist) - dist_base.begin() - 1;
+            bw.put(dist_code[dc], dist_len[dc]);
+            if (dist_extra[dc] > 0) bw.put(t.dist - dist_base[dc], dist_extra[dc]);
+        }
+        bw.put(lit_code[256], lit_len[256]);
+    }
+}
+
+namespace qrb::zip {
+    std::vector<uint8_t> compress(const std::span<const uint8_t> data) {
+        std::vector<uint8_t> out = {0x78, 0x01}; // 32K窗口，最快压缩等级
+        out.reserve(data.size() / 4);
+        bit_writer bw{out};
+        deflate(data, 0, true, bw);
+        bw.flush();
+
+        const auto adler = adler32(data);
+        for (int i = 3; i >= 0; --i) out.push_back(static_cast<uint8_t>((adler >> (8 * i)) & 0xFF));
+        return out;
+    }
+
+    uint64_t compress(const std::function<size_t(std::span<uint8_t>)>& read, const std::function<void(std::span<const uint8_t>)>& write) {
+        std::vector<uint8_t> out = {0x78, 0x01}, data;
+        data.reserve(window + chunk);
+        bit_writer bw{out};
+        uint32_t adler = 1;
+        uint64_t total = 0;
+        while (true) {
+            const auto keep = std::min<size_t>(data.size(), window); // 上一段的末尾留作回溯窗口
+            data.erase(data.begin(), data.end() - static_cast<int64_t>(keep));
+            data.resize(keep + chunk);
+            size_t n = 0;
+            for (size_t got = 1; n < chunk && got != 0; n += got) got = read(std::span{data}.subspan(keep + n, chunk - n));
+            data.resize(keep + n);
+            if (n == 0) break;
+
+            adler = adler32(std::span{data}.subspan(keep), adler);
+            total += n;
+            deflate(data, keep, false, bw);
+            write(out);
+            out.clear();
+        }
+        bw.put(1, 1); // 末块为只含块结束符的固定哈夫曼块，读尽之前无法得知哪一段是最后一段
+        bw.put(1, 2);
+        bw.put(0, 7);
+        bw.flush();
+
+        for (int i = 3; i >= 0; --i) out.push_back(static_cast<uint8_t>((adler >> (8 * i)) & 0xFF));
+        write(out);
+        return total;
+    }
+
+    bool decompress(const std::function<size_t(std::span<uint8_t>)>& read, const std::function<void(std::span<const uint8_t>)>& write, const uint64_t max_size) {
+        bit_reader br{read};
+        const auto cmf = br.get(8), flg = br.get(8);
+        if (br.error || (cmf & 0x0F) != 8 || (cmf >> 4) > 7 || ((cmf << 8) | flg) % 31 != 0 || (flg & 0x20)) return false; // 仅支持无预设字典的deflate
+
+        window_writer output{write, max_size, {}};
+        output.buf.reserve(2 * window + max_match);
+        huffman lit, dist;
+        for (bool last = false; !last;) {
+            last = br.get(1) != 0;
+            const auto type = br.get(2);
+            if (br.error) return false;
+
+            if (type == 0) { // 存储块
+                br.align();
+                const auto len = br.get(16), nlen = br.get(16);
+                if (br.error || len != (~nlen & 0xFFFF) || output.over(len)) return false;
+                for (uint32_t i = 0; i < len; ++i) output.buf.push_back(static_cast<uint8_t>(br.get(8)));
+                if (br.error) return false;
+                if (output.buf.size() >= 2 * window) output.spill(window);
+            } else if (type == 1) { // 固定哈夫曼
+                std::array<uint8_t, 288> lit_len{};
+                std::fill_n(lit_len.begin(), 144, 8);
+                std::fill_n(lit_len.begin() + 144, 112, 9);
+                std::fill_n(lit_len.begin() + 256, 24, 7);
+                std::fill_n(lit_len.begin() + 280, 8, 8);
+                std::array<uint8_t, 30> dist_len{};
+                dist_len.fill(5);
+                lit.build(lit_len);
+                dist.build(dist_len);
+                if (!inflate_block(br, lit, dist, output)) return false;
+            } else if (type == 2) { // 动态哈夫曼
+                const auto hlit = br.get(5) + 257, hdist = br.get(5) + 1, hclen = br.get(4) + 4;
+                if (br.error || hlit > 286 || hdist > 30) return false;
+
+                std::array<uint8_t, 19> cl_len{};
+                for (uint32_t i = 0; i < hclen; ++i) cl_len[cl_order[i]] = static_cast<uint8_t>(br.get(3));
+                huffman cl;
+                if (br.error || !cl.build(cl_len)) return false;
+
+                std::vector<uint8_t> seq;
+                while (seq.size() < hlit + hdist) {
+                    const auto sym = cl.decode(br);
+                    if (sym < 0) return false;
+                    if (sym < 16) { seq.push_back(static_cast<uint8_t>(sym)); continue; }
+                    if (sym == 16 && seq.empty()) return false;
+                    const uint8_t v = sym == 16 ? seq.back() : 0;
+                    const auto run = sym == 16 ? 3 + br.get(2) : sym == 17 ? 3 + br.get(3) : 11 + br.get(7);
+                    if (br.error || seq.size() + run > hlit + hdist) return false;
+                    seq.insert(seq.end(), run, v);
+                }
+                if (seq[256] == 0) return false; // 缺少块结束符
+
+                if (!lit.build(std::span{seq}.first(hlit)) || !dist.build(std::span{seq}.subspan(hlit))) return false;
+                if (!inflate_block(br, lit, dist, output)) return false;
+            } else return false;
+        }
+
+        output.spill(0);
+        br.align();
+        uint32_t adler = 0;
+        for (int i = 0; i < 4; ++i) adler = (adler << 8) | br.get(8);
+        return !br.error && adler == output.adler;
+    }
+
+    bool decompress(const std::span<const uint8_t> data, std::vector<uint8_t>& output, const uint64_t max_size) {
+        output.clear();
+        size_t pos = 0;
+        return decompress([&](const std::span<uint8_t> buf) {
+            const auto n = std::min(buf.size(), data.size() - pos);
+            std::copy_n(data.begin() + static_cast<int64_t>(pos), n, buf.begin());
+            pos += n;
+            return n;
+        }, [&](const std::span<const uint8_t> chunk) { output.insert(output.end(), chunk.begin(), chunk.end()); }, max_size);
+    }
+}
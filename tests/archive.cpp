@@ -0,0 +1,184 @@
+#include <fstream>
+#include <string>
+#include <vector>
+#include <span>
+#include <random>
+
+#include <qrb/zip.h>
+#include <qrb/archive.h>
+
+#include "check.h"
+
+using qrb::test::check;
+
+namespace {
+    const auto base = fs::temp_directory_path() / "qrb_test_archive";
+
+    void save(const fs::path& file, const std::vector<uint8_t>& data) {
+        fs::create_directories(file.parent_path());
+        std::ofstream(file, std::ios::binary).write(reinterpret_cast<const char*>(data.data()), static_cast<int64_t>(data.size()));
+    }
+
+    std::vector<uint8_t> load(const fs::path& file) {
+        std::ifstream input(file, std::ios::binary);
+        return {std::istreambuf_iterator<char>(input), {}};
+    }
+
+    std::vector<uint8_t> drain(const uint64_t total, const size_t chunk) { // 按固定大小分段读出整个归档
+        std::vector<uint8_t> stream(total);
+        for (uint64_t pos = 0; pos < total; ) {
+            const auto len = static_cast<size_t>(std::min<uint64_t>(chunk, total - pos));
+            check(qrb::archive::read(std::span{stream}.subspan(pos, len)) == len);
+            pos += len;
+        }
+        return stream;
+    }
+
+    void put(std::vector<uint8_t>& out, uint64_t value) {
+        do {
+            out.push_back(static_cast<uint8_t>((value & 0x7F) | (value > 0x7F ? 0x80 : 0)));
+            value >>= 7;
+        } while (value != 0);
+    }
+
+    std::vector<uint8_t> forge(const std::string& root, const std::string& name, const uint8_t codec, const std::vector<uint8_t>& data, const uint64_t size) { // 手工构造单成员归档
+        std::vector<uint8_t> head, stream = {'q', 'r', 'b', 'a'};
+        put(head, root.size());
+        head.insert(head.end(), root.begin(), root.end());
+        put(head, 1);
+        put(head, name.size());
+        head.insert(head.end(), name.begin(), name.end());
+        head.push_back(codec);
+        put(head, data.size());
+        put(head, size);
+        put(stream, head.size());
+        stream.insert(stream.end(), head.begin(), head.end());
+        stream.insert(stream.end(), data.begin(), data.end());
+        return stream;
+    }
+
+    bool unpack(const std::vector<uint8_t>& stream, const fs::path& output_dir) {
+        const auto len = qrb::archive::size(stream);
+        if (len == 0) return false;
+        const auto [root, items] = qrb::archive::list(std::span{stream}.first(std::min<size_t>(len, stream.size())));
+        if (items.empty()) return false;
+        for (const auto& item : items) {
+            if (item.offset + item.length > stream.size()) return false;
+            if (!qrb::archive::extract(item, std::span{stream}.subspan(item.offset, item.length), output_dir / root)) return false;
+        }
+        return true;
+    }
+
+    void round_trip(const bool compress) { // 打包后分段读出，解包结果与源目录一致
+        const auto input = base / "in", output = base / "out";
+        fs::remove_all(base);
+        const std::vector<std::pair<std::string, std::vector<uint8_t>>> files = {
+            {"a.bin", qrb::test::bytes(70000, 1)},
+            {"empty", {}},
+            {"sub/b.txt", std::vector<uint8_t>(5000, 'b')},
+            {"sub/deep/c.bin", qrb::test::bytes(300, 2)},
+        };
+        for (const auto& [name, data] : files) save(input / name, data);
+
+        for (const size_t chunk : {size_t{1}, size_t{7}, size_t{4096}, size_t{1} << 20}) {
+            const auto total = qrb::archive::pack(input, u8"in", compress);
+            check(total != 0);
+            const auto stream = drain(total, chunk);
+            std::vector<uint8_t> rest(16);
+            check(qrb::archive::read(rest) == 0); // 读完后不再有数据
+            qrb::archive::clean();
+
+            const auto [root, items] = qrb::archive::list(stream);
+            check(root == "in" && items.size() == files.size());
+            for (size_t i = 0; i < items.size() && i < files.size(); ++i) {
+                check(items[i].name == files[i].first && items[i].size == files[i].second.size());
+                if (!compress || files[i].first == "sub/b.txt") check(items[i].codec == (compress ? 1 : 0)); // 重复内容压缩有收益
+                check(qrb::archive::match(items[i], files[i].first) && qrb::archive::match(items[i], fs::path(files[i].first).filename().string()));
+            }
+
+            fs::remove_all(output);
+            check(unpack(stream, output));
+            for (const auto& [name, data] : files) check(load(output / "in" / name) == data);
+        }
+        fs::remove_all(base);
+    }
+
+    std::vector<uint8_t> noise(const size_t size, const uint32_t seed) { // 无法压缩的数据，按存储处理
+        std::mt19937 rng(seed);
+        std::vector<uint8_t> data(size);
+        for (auto& b : data) b = static_cast<uint8_t>(rng());
+        return data;
+    }
+
+    void resized() { // 存储的成员在打包后改变大小时报告，其余成员不受影响
+        const auto input = base / "in";
+        fs::remove_all(base);
+        save(input / "a", noise(5000, 4));
+        save(input / "b", noise(5000, 5));
+        save(input / "c", std::vector<uint8_t>(3 << 20, 'c')); // 跨越多个压缩分段
+
+        for (const bool shrink : {true, false}) {
+            const auto total = qrb::archive::pack(input, u8"in", true);
+            check(total != 0);
+            save(input / "a", noise(shrink ? 4000 : 6000, 4));
+            const auto stream = drain(total, 4096);
+            check(qrb::archive::changed() == std::vector<fs::path>{input / "a"});
+            qrb::archive::clean();
+            check(qrb::archive::changed().empty());
+
+            const auto [root, items] = qrb::archive::list(stream);
+            check(items.size() == 3 && items[0].codec == 0 && items[1].codec == 0 && items[2].codec == 1);
+            fs::remove_all(base / "out");
+            check(unpack(stream, base / "out"));
+            check(load(base / "out/in/b") == load(input / "b") && load(base / "out/in/c") == load(input / "c"));
+            save(input / "a", noise(5000, 4));
+        }
+        fs::remove_all(base);
+    }
+
+    void malformed() {
+        const auto output = base / "bad";
+        fs::remove_all(base);
+        const auto data = qrb::test::bytes(2000, 3);
+        const auto packed = qrb::zip::compress(data);
+
+        check(unpack(forge("r", "f", 0, data, data.size()), output) && load(output / "r/f") == data);
+        check(unpack(forge("r", "f", 1, packed, data.size()), output) && load(output / "r/f") == data);
+
+        auto stream = forge("r", "g", 1, packed, data.size());
+        check(qrb::archive::list(std::span{stream}.first(stream.size() - packed.size() - 1)).second.empty()); // 目录被截断
+        stream[0] = 'x';
+        check(qrb::archive::size(stream) == 0); // 标识错误
+
+        check(!unpack(forge("r", "../x", 0, data, data.size()), output)); // 路径穿越
+        check(!unpack(forge("r", "/x", 0, data, data.size()), output));
+        check(!unpack(forge("r", "", 0, data, data.size()), output));
+        check(!unpack(forge("a/b", "f", 0, data, data.size()), output)); // 根名称含分隔符
+        check(!unpack(forge("..", "f", 0, data, data.size()), output));
+        check(!unpack(forge("", "f", 0, data, data.size()), output));
+        check(!unpack(forge("r", "f", 2, data, data.size()), output)); // 未知压缩格式
+        check(!unpack(forge("r", "h", 0, data, data.size() + 1), output)); // 存储成员长度与原始字节数不符
+        check(!fs::exists(output / "r/h"));
+
+        auto broken = packed; // 压缩数据损坏或解压结果超过原始字节数时不保留该成员
+        broken[broken.size() / 2] ^= 0x55;
+        check(!unpack(forge("r", "i", 1, broken, data.size()), output));
+        check(!fs::exists(output / "r/i"));
+        check(!unpack(forge("r", "j", 1, packed, data.size() - 1), output));
+        check(!fs::exists(output / "r/j"));
+
+        check(qrb::archive::pack(base / "missing", u8"missing", true) == 0);
+        fs::create_directories(base / "void");
+        check(qrb::archive::pack(base / "void", u8"void", true) == 0); // 不含文件的目录
+        qrb::archive::clean();
+        fs::remove_all(base);
+    }
+}
+
+int main() {
+    round_trip(true);
+    round_trip(false);
+    resized();
+    malformed();
+    return qrb::test::finish();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <source_location>
+
+namespace qrb::test {
+    inline int failures = 0;
+
+    // 条件不成立时输出所在位置并计数，不中断后续检查
+    inline void check(const bool ok, const std::source_location where = std::source_location::current()) {
+        if (ok) return;
+        ++failures;
+        std::cerr << "FAIL " << where.file_name() << ":" << where.line() << std::endl;
+    }
+
+    // 固定种子的伪随机字节，混入少量重复片段，使压缩相关的路径都能覆盖到
+    inline std::vector<uint8_t> bytes(const size_t size, const uint32_t seed) {
+        std::mt19937 rng(seed);
+        std::vector<uint8_t> data(size);
+        for (size_t i = 0; i < size; ++i) data[i] = rng() % 4 == 0 && i >= 64 ? data[i - 64] : static_cast<uint8_t>(rng());
+        return data;
+    }
+
+    // 汇总结果作为进程退出码
+    inline int finish() {
+        if (failures == 0) std::cout << "OK" << std::endl;
+        return failures == 0 ? 0 : 1;
+    }
+}
@@ -0,0 +1,80 @@
+#include <vector>
+#include <span>
+
+#include <qrb/fountain.h>
+
+#include "check.h"
+
+using qrb::test::check;
+
+namespace {
+    constexpr uint32_t cap = 200;
+
+    std::vector<uint8_t> symbol(const uint32_t seed, const std::vector<uint8_t>& source) {
+        std::vector<uint8_t> block(cap);
+        qrb::fountain::encode(seed, source, block);
+        return block;
+    }
+
+    void round_trip(const size_t size, const uint32_t drop) { // 丢弃前drop个系统符号，仅用其余符号与修复符号恢复
+        const auto source = qrb::test::bytes(size, static_cast<uint32_t>(size));
+        const auto k = qrb::fountain::config(source.size(), cap);
+        check(k > 0);
+        const auto n = k + k / 2 + 16;
+
+        std::vector<std::vector<uint8_t>> blocks;
+        for (uint32_t seed = 0; seed < n; ++seed) blocks.push_back(symbol(seed, source));
+
+        qrb::fountain::clean();
+        for (uint32_t seed = drop; seed < n; ++seed) {
+            check(qrb::fountain::check(blocks[seed]));
+            qrb::fountain::insert(blocks[seed]);
+        }
+        check(qrb::fountain::received() == n - drop);
+
+        std::vector<uint8_t> result;
+        check(qrb::fountain::solve(result));
+        check(result == source);
+        qrb::fountain::clean();
+    }
+
+    void malformed() {
+        const auto source = qrb::test::bytes(5000, 7);
+        const auto k = qrb::fountain::config(source.size(), cap);
+        const auto block = symbol(k + 3, source);
+
+        check(!qrb::fountain::check(std::vector<uint8_t>{0, 0}));   // 截断的头部
+        check(!qrb::fountain::check(std::vector<uint8_t>(cap, 1))); // 普通文件块
+
+        qrb::fountain::clean();
+        check(!qrb::fountain::insert(std::span{block}.first(3)));
+        check(qrb::fountain::insert(block));
+        check(!qrb::fountain::insert(block)); // 重复符号
+        check(qrb::fountain::received() == 1);
+
+        std::vector<uint8_t> result;
+        check(!qrb::fountain::solve(result)); // 符号不足
+        qrb::fountain::clean();
+
+        auto forged = block; // 头部声明的总字节数超过上限，不能据此分配
+        forged[5] = forged[6] = forged[7] = forged[8] = 0xFF;
+        forged[9] = 0x7F;
+        check(!qrb::fountain::insert(forged));
+        check(qrb::fountain::received() == 0);
+        qrb::fountain::clean();
+
+        check(qrb::fountain::config(0, cap) == 0);
+        check(qrb::fountain::config(1000, 4) == 0); // 容量放不下头部
+        check(qrb::fountain::config(qrb::fountain::max_total + 1, cap) == 0);
+    }
+}
+
+int main() {
+    round_trip(1, 0);
+    round_trip(cap, 0);
+    round_trip(10000, 0);
+    round_trip(10000, 20);
+    round_trip(100000, 100);
+    malformed();
+    return qrb::test::finish();
+}
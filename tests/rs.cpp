@@ -0,0 +1,89 @@
+#include <vector>
+#include <span>
+
+#include <qrb/rs.h>
+
+#include "check.h"
+
+using qrb::test::check;
+
+namespace {
+    constexpr uint32_t cap = 120;
+
+    struct coded {
+        std::vector<uint8_t> source;
+        std::vector<uint8_t> parity; // 各组的全部校验块依次排列
+    };
+
+    coded encode(const size_t size, const uint32_t k, const uint32_t m) {
+        coded c{qrb::test::bytes(size, static_cast<uint32_t>(size * 31 + k)), {}};
+        check(qrb::rs::config(c.source.size(), cap, k, m));
+        c.parity.resize(static_cast<size_t>(qrb::rs::stripes()) * m * cap);
+        for (uint32_t s = 0; s < qrb::rs::stripes(); ++s) qrb::rs::encode(s, c.source, std::span{c.parity}.subspan(static_cast<size_t>(s) * m * cap, m * cap));
+        return c;
+    }
+
+    std::vector<uint8_t> symbol(const std::vector<uint8_t>& source, const uint32_t stripe, const uint32_t p) { // 第p个数据符号，末符号补零
+        std::vector<uint8_t> result(qrb::rs::symbol(), 0);
+        const auto beg = (static_cast<uint64_t>(p) * qrb::rs::stripes() + stripe) * qrb::rs::symbol();
+        for (size_t i = 0; i < result.size() && beg + i < source.size(); ++i) result[i] = source[beg + i];
+        return result;
+    }
+
+    void round_trip(const size_t size, const uint32_t k, const uint32_t m) { // 每组丢失前m个数据符号后恢复
+        const auto c = encode(size, k, m);
+        const auto s_cnt = qrb::rs::stripes();
+
+        qrb::rs::clean();
+        for (size_t b = 0; b < c.parity.size(); b += cap) check(qrb::rs::insert(std::span{c.parity}.subspan(b, cap)));
+        check(qrb::rs::stripes() == s_cnt && qrb::rs::data() == k && qrb::rs::parity() == m);
+
+        for (uint32_t s = 0; s < s_cnt; ++s) {
+            std::vector<std::vector<uint8_t>> symbols(k), expect(k);
+            std::vector<bool> known(k, true);
+            for (uint32_t p = 0; p < k; ++p) {
+                expect[p] = symbols[p] = symbol(c.source, s, p);
+                if (p < m) { known[p] = false; symbols[p].assign(qrb::rs::symbol(), 0xAA); }
+            }
+            check(qrb::rs::solve(s, symbols, known));
+            check(symbols == expect);
+        }
+        qrb::rs::clean();
+    }
+
+    void malformed() {
+        const auto c = encode(3000, 4, 2);
+        const auto block = std::span{c.parity}.first(cap);
+
+        qrb::rs::clean();
+        check(!qrb::rs::insert(block.first(12))); // 只有头部
+        check(!qrb::rs::insert(std::vector<uint8_t>(cap, 0))); // k与m为零
+        check(qrb::rs::insert(block));
+        check(!qrb::rs::insert(block.first(cap - 1))); // 长度与首块不同
+        auto other = std::vector<uint8_t>(block.begin(), block.end());
+        other[1] = 5; // k与首块不同
+        check(!qrb::rs::insert(other));
+        other[1] = 4;
+        other[3] = 2; // 行号超出m
+        check(!qrb::rs::insert(other));
+
+        std::vector<std::vector<uint8_t>> symbols(4, std::vector<uint8_t>(qrb::rs::symbol(), 0));
+        check(!qrb::rs::solve(1, symbols, {false, true, true, true})); // 该组没有校验块
+        check(!qrb::rs::solve(0, symbols, {false, false, true, true})); // 缺失数多于已收到的校验块
+        qrb::rs::clean();
+
+        check(!qrb::rs::config(0, cap, 4, 2));
+        check(!qrb::rs::config(1000, 12, 4, 2)); // 容量放不下头部
+        check(!qrb::rs::config(1000, cap, 200, 57)); // k + m超过256
+        check(!qrb::rs::config(qrb::rs::max_total + 1, cap, 4, 2));
+    }
+}
+
+int main() {
+    round_trip(1, 1, 1);
+    round_trip(5000, 4, 2);
+    round_trip(20000, 10, 4);
+    round_trip(50000, 200, 56);
+    malformed();
+    return qrb::test::finish();
+}
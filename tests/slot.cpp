@@ -0,0 +1,162 @@
+#include <vector>
+#include <span>
+#include <random>
+#include <algorithm>
+
+#include <qrb/slot.h>
+#include <qrb/index.h>
+
+#include "check.h"
+
+using qrb::test::check;
+
+namespace {
+    std::vector<std::vector<uint8_t>> encode(const std::vector<uint8_t>& data, const uint32_t cap, const uint32_t per_page) { // 按v2格式切分为各块，与编码时的分块一致
+        std::vector<std::vector<uint8_t>> blocks;
+        if (!qrb::slot::config(data.size(), cap, per_page)) return blocks;
+        uint64_t offset = 0;
+        for (uint32_t i = 1; i <= qrb::slot::count(); ++i) {
+            check(offset == (i - 1) * static_cast<uint64_t>(cap) - qrb::slot::sum(i));
+            if (i < qrb::slot::count()) check(qrb::slot::sum(i + 1) - qrb::slot::sum(i) == qrb::slot::len(i));
+            const auto head = qrb::slot::len(i);
+            const auto count = std::min<uint64_t>(cap - head, data.size() - offset);
+            std::vector<uint8_t> block(head + count);
+            qrb::slot::encode(i, block);
+            std::copy_n(data.begin() + static_cast<int64_t>(offset), count, block.begin() + head);
+            offset += count;
+            blocks.push_back(std::move(block));
+        }
+        check(offset == data.size());
+        return blocks;
+    }
+
+    void round_trip(const size_t size, const uint32_t cap, const uint32_t per_page) { // 逐页打乱顺序后解析，还原全部数据
+        const auto data = qrb::test::bytes(size, static_cast<uint32_t>(size * 7 + per_page));
+        const auto blocks = encode(data, cap, per_page);
+        check(!blocks.empty());
+        const auto n = qrb::slot::count();
+        for (uint32_t i = 1; i < n; ++i) check(blocks[i - 1].size() == cap);
+        check(blocks.back().size() < cap && qrb::slot::check(blocks.back())); // 尾块总是不足整块的定位块
+
+        qrb::slot::clean();
+        std::mt19937 rng(cap + per_page);
+        std::vector<uint8_t> output(size);
+        for (uint32_t beg = 0; beg < n; beg += per_page) {
+            std::vector<uint32_t> order(std::min(per_page, n - beg));
+            for (uint32_t i = 0; i < order.size(); ++i) order[i] = beg + i + 1;
+            std::ranges::shuffle(order, rng);
+
+            std::vector<std::vector<uint8_t>> page;
+            for (const auto i : order) page.push_back(blocks[i - 1]);
+            const auto slots = qrb::slot::decode(page);
+            check(slots == order);
+            for (size_t j = 0; j < page.size(); ++j) {
+                if (page[j].size() < cap) qrb::slot::last(slots[j]); // 读到尾块后才知道其头部长度
+                const auto head = qrb::slot::len(slots[j]);
+                const auto offset = (slots[j] - 1) * static_cast<uint64_t>(cap) - qrb::slot::sum(slots[j]);
+                std::copy(page[j].begin() + head, page[j].end(), output.begin() + static_cast<int64_t>(offset));
+            }
+        }
+        check(qrb::slot::active() && qrb::slot::cap() == per_page);
+        check(output == data);
+        qrb::slot::clean();
+    }
+
+    void malformed() {
+        constexpr uint32_t cap = 50, per_page = 6;
+        const auto blocks = encode(qrb::test::bytes(2000, 3), cap, per_page);
+        check(blocks.size() > 2 * per_page);
+
+        qrb::slot::clean();
+        const std::vector<std::vector<uint8_t>> compact(blocks.begin() + 1, blocks.begin() + per_page - 1);
+        check(std::ranges::all_of(qrb::slot::decode(compact), [](const auto i) { return i == 0; })); // 缺少定位块的页无法定位
+        check(!qrb::slot::active() && qrb::slot::cap() == 0);
+
+        const std::vector<std::vector<uint8_t>> mixed = {blocks[0], blocks[1], blocks[per_page]}; // 两页的定位块出现在同一图像中，紧凑块按页号低位区分
+        check(qrb::slot::decode(mixed) == std::vector<uint32_t>{1, 2, per_page + 1});
+
+        const std::vector<std::vector<uint8_t>> empty = {{}, {0x81}, blocks[per_page - 1]};
+        check(qrb::slot::decode(empty) == std::vector<uint32_t>{0, 0, per_page}); // 空块与过短的块
+
+        auto other = blocks[0]; // 每页个数与已知矛盾的定位块
+        other[3] ^= 0x01;
+        check(qrb::slot::decode({other}) == std::vector<uint32_t>{0});
+
+        qrb::slot::clean();
+        auto outside = blocks[0]; // 页内位置超出每页个数
+        outside[2] |= 0x7F;
+        check(qrb::slot::decode({outside}) == std::vector<uint32_t>{0});
+        check(!qrb::slot::active());
+        auto middle = blocks[0]; // 不在首末位置的定位块只能是尾块
+        middle[2] |= 0x02;
+        check(qrb::slot::decode({middle}) == std::vector<uint32_t>{3});
+        qrb::slot::last(per_page + 2);
+        check(qrb::slot::decode({blocks[per_page + 2]}) == std::vector<uint32_t>{0}); // 在尾块之后
+
+        check(!qrb::slot::config(1000, 4, 1)); // 容量不足以容纳定位块
+        check(!qrb::slot::config(1000, 50, 0));
+        check(!qrb::slot::config(1000, 50, qrb::slot::max_cap + 1));
+        check(qrb::slot::config(1000, 50, qrb::slot::max_cap));
+        check(!qrb::slot::config(uint64_t{50} << 14, 50, 1)); // 页号超出14位
+        qrb::slot::clean();
+    }
+
+    void orphan() { // 同一图像中没有定位块的紧凑块，读到尾块后由总页数定位
+        constexpr uint32_t cap = 50, per_page = 3;
+        for (const size_t size : {size_t{2000}, size_t{60000}}) { // 页数不超过256与超过256
+            const auto blocks = encode(qrb::test::bytes(size, 5), cap, per_page);
+            const auto n = qrb::slot::count();
+            const auto pages = (n - 1) / per_page + 1;
+            check((pages > 256) == (size > 2000) && pages > 2);
+
+            qrb::slot::clean();
+            check(qrb::slot::decode({blocks[0]}) == std::vector<uint32_t>{1});
+            const std::vector<std::vector<uint8_t>> compact = {blocks[per_page + 1]}; // 第2页的紧凑块
+            check(qrb::slot::decode(compact) == std::vector<uint32_t>{0});
+            qrb::slot::last(n);
+            check(qrb::slot::count() == n);
+            check(qrb::slot::decode(compact) == std::vector<uint32_t>{pages > 256 ? 0 : per_page + 2}); // 第2页与第258页的低位相同
+            check(qrb::slot::decode({blocks[per_page], blocks[per_page + 1]}) == std::vector<uint32_t>{per_page + 1, per_page + 2});
+            if (pages > 257) check(qrb::slot::decode({blocks[per_page], blocks[per_page + 1], blocks[257 * per_page]}) == std::vector<uint32_t>{per_page + 1, 0, 257 * per_page + 1}); // 两页定位块低位相同
+        }
+        qrb::slot::clean();
+    }
+
+    uint64_t plain_blocks(const uint64_t total, const uint32_t cap) { // v1格式的块数，与file.cpp的尾块判断一致
+        uint64_t used = 0;
+        for (uint32_t i = 1; ; ++i) {
+            const uint64_t len = cap - qrb::index::len(i);
+            if (qrb::index::len(0) + total - used <= len) return i;
+            used += len;
+        }
+    }
+
+    void density() { // 每个符号承载的数据字节数，v2紧凑块带页号低位，块数多到v1序号占3字节且每页个数足够时才不低于v1
+        qrb::index::config(0);
+        for (const uint32_t cap : {53u, 271u, 1273u, 2953u}) {
+            for (const uint64_t total : {uint64_t{1} << 12, uint64_t{1} << 16, uint64_t{1} << 20, uint64_t{1} << 24}) {
+                const auto v1 = plain_blocks(total, cap);
+                for (const uint32_t per_page : {1u, 2u, 8u, 12u, 54u, 128u}) {
+                    if (!qrb::slot::config(total, cap, per_page)) continue;
+                    const auto v2 = uint64_t{qrb::slot::count()};
+                    const auto payload = [&](const uint64_t n) { return static_cast<double>(total) / static_cast<double>(n); };
+                    if (per_page >= 8 && v1 >= 65536) check(payload(v2) >= payload(v1));
+                    if (v1 < 16384) check(v2 >= v1); // v1序号至多2字节，少于紧凑块与定位块的平均头部
+                    if (per_page <= 2 && v1 >= 1024) check(payload(v2) < payload(v1)); // 每块都是定位块时比v1多占头部
+                }
+            }
+        }
+        qrb::slot::clean();
+    }
+}
+
+int main() {
+    for (const uint32_t per_page : {1u, 2u, 3u, 6u, 54u, 128u}) {
+        for (const size_t size : {size_t{0}, size_t{1}, size_t{45}, size_t{46}, size_t{47}, size_t{1000}, size_t{25000}}) round_trip(size, 50, per_page);
+    }
+    round_trip(300000, 1273, 54);
+    malformed();
+    orphan();
+    density();
+    return qrb::test::finish();
+}
@@ -0,0 +1,108 @@
+#include <vector>
+#include <span>
+
+#include <qrb/zip.h>
+
+#include "check.h"
+
+using qrb::test::check;
+
+namespace {
+    void round_trip(const std::vector<uint8_t>& source) {
+        const auto packed = qrb::zip::compress(source);
+        std::vector<uint8_t> result;
+        check(qrb::zip::decompress(packed, result, source.size()));
+        check(result == source);
+
+        // 逐字节读入、分片写出，结果应与整体解压相同
+        size_t pos = 0, chunks = 0;
+        std::vector<uint8_t> streamed;
+        check(qrb::zip::decompress([&](const std::span<uint8_t> buf) {
+            if (pos == packed.size() || buf.empty()) return size_t{0};
+            buf[0] = packed[pos++];
+            return size_t{1};
+        }, [&](const std::span<const uint8_t> chunk) {
+            check(chunk.size() <= 2 * 32768 + 258);
+            streamed.insert(streamed.end(), chunk.begin(), chunk.end());
+            ++chunks;
+        }, source.size()));
+        check(streamed == source);
+        check(chunks >= source.size() / (2 * 32768 + 258));
+    }
+
+    size_t stream(const std::vector<uint8_t>& source, const size_t piece) { // 分段读入流式压缩，结果可按常规数据流解压
+        size_t pos = 0;
+        std::vector<uint8_t> packed, result;
+        check(qrb::zip::compress([&](const std::span<uint8_t> buf) {
+            const auto n = std::min({buf.size(), piece, source.size() - pos});
+            std::copy_n(source.begin() + static_cast<int64_t>(pos), n, buf.begin());
+            pos += n;
+            return n;
+        }, [&](const std::span<const uint8_t> chunk) { packed.insert(packed.end(), chunk.begin(), chunk.end()); }) == source.size());
+        check(qrb::zip::decompress(packed, result, source.size()) && result == source);
+        return packed.size();
+    }
+
+    void limit() { // 输出超过上限时失败，不必先得到完整结果
+        const std::vector<uint8_t> zeros(1 << 20, 0);
+        const auto packed = qrb::zip::compress(zeros);
+        check(packed.size() < zeros.size() / 100);
+
+        std::vector<uint8_t> result;
+        check(!qrb::zip::decompress(packed, result, zeros.size() - 1));
+
+        uint64_t written = 0;
+        check(!qrb::zip::decompress(packed, result, 1000));
+        check(!qrb::zip::decompress([&, pos = size_t{0}](const std::span<uint8_t> buf) mutable {
+            const auto n = std::min(buf.size(), packed.size() - pos);
+            std::copy_n(packed.begin() + static_cast<int64_t>(pos), n, buf.begin());
+            pos += n;
+            return n;
+        }, [&](const std::span<const uint8_t> chunk) { written += chunk.size(); }, 100000));
+        check(written <= 100000);
+    }
+
+    void malformed() {
+        const auto source = qrb::test::bytes(20000, 3);
+        const auto packed = qrb::zip::compress(source);
+        std::vector<uint8_t> result;
+
+        check(!qrb::zip::decompress(std::span<const uint8_t>{}, result, 1 << 20));
+        check(!qrb::zip::decompress(std::span{packed}.first(packed.size() / 2), result, 1 << 20)); // 截断
+        check(!qrb::zip::decompress(std::span{packed}.first(packed.size() - 1), result, 1 << 20)); // 缺少校验值
+
+        auto bad = packed;
+        bad[0] = 0x79; // 非deflate
+        check(!qrb::zip::decompress(bad, result, 1 << 20));
+        bad = packed;
+        bad[bad.size() - 1] ^= 1; // 校验值错误
+        check(!qrb::zip::decompress(bad, result, 1 << 20));
+
+        const std::vector<uint8_t> far = {0x78, 0x01, 0x03, 0x02, 0x00}; // 固定哈夫曼块，首个符号即回溯1字节，超过已输出字节
+        check(!qrb::zip::decompress(far, result, 1 << 20));
+
+        for (size_t i = 2; i + 4 < packed.size(); i += 97) { // 翻转任意一位都不能越界或通过校验
+            bad = packed;
+            bad[i] ^= 0x10;
+            check(!qrb::zip::decompress(bad, result, 1 << 20) || result == source);
+        }
+    }
+}
+
+int main() {
+    round_trip({});
+    round_trip({42});
+    round_trip(qrb::test::bytes(1000, 1));
+    round_trip(qrb::test::bytes(300000, 2));
+    round_trip(std::vector<uint8_t>(200000, 7));
+    stream({}, 1);
+    stream(qrb::test::bytes(1000, 4), 7);
+    const auto unit = qrb::test::bytes(20000, 5);
+    std::vector<uint8_t> repeated; // 跨越1 MiB分块边界的重复内容
+    for (int i = 0; i < 100; ++i) repeated.insert(repeated.end(), unit.begin(), unit.end());
+    check(stream(repeated, 100000) < repeated.size() / 20);
+    stream(qrb::test::bytes(3 << 20, 6), 1 << 20);
+    limit();
+    malformed();
+    return qrb::test::finish();
+}